@@ -0,0 +1,267 @@
+// Runs the search algorithms over MovingAI scenario files and prints the
+// results as JSON:
+//
+//   benchmark [--algorithms astar,jps,...] [--queries] file.scen...
+//
+// Maps are read from the path in the scenario, relative to the scenario file.
+// A packed .pfmap next to the .map is used instead when there is one. A map
+// that can't be read gets an error entry and the exit status is 1.
+
+#include "Algorithms.h"
+#include "Map.h"
+#include "MapFile.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct Scenario {
+    std::string map;
+    unsigned int width;
+    unsigned int height;
+    unsigned int startX;
+    unsigned int startY;
+    unsigned int goalX;
+    unsigned int goalY;
+    double optimal;
+};
+
+struct Result {
+    double latency;
+    unsigned int expansions;
+    double cost;
+    bool solved;
+};
+
+static std::vector<Scenario> readScenarios(const std::string& path) {
+    std::ifstream file(path.c_str());
+    std::vector<Scenario> scenarios;
+    std::string line;
+
+    while(std::getline(file, line)) {
+        std::istringstream fields(line);
+        unsigned int bucket;
+        Scenario s;
+
+        if(fields >> bucket >> s.map >> s.width >> s.height >> s.startX >> s.startY >> s.goalX >> s.goalY >> s.optimal) {
+            scenarios.push_back(s);
+        }
+    }
+
+    return scenarios;
+}
+
+static std::string directoryOf(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? "" : path.substr(0, slash + 1);
+}
+
+static bool loadMap(const std::string& path, Map& map) {
+    std::string packed = path.substr(0, path.find_last_of('.')) + ".pfmap";
+    MapFile file;
+
+    if(file.open(packed) && file.load(map)) {
+        return true;
+    }
+
+    return MapFile::importMovingAI(path, map);
+}
+
+// Path length in the scenario's units, where a diagonal move costs sqrt(2).
+// Any-angle paths are measured segment by segment.
+static double length(const Map& map, const std::vector<unsigned int>& path) {
+    double total = 0;
+
+    for(unsigned int k = 1; k < path.size(); ++k) {
+        double di = (double) map.column(path[k - 1]) - map.column(path[k]);
+        double dj = (double) map.row(path[k - 1]) - map.row(path[k]);
+        total += std::sqrt(di * di + dj * dj);
+    }
+
+    return total;
+}
+
+static double percentile(std::vector<double> values, double p) {
+    if(values.empty()) {
+        return 0;
+    }
+
+    std::sort(values.begin(), values.end());
+    size_t rank = (size_t) std::ceil(p / 100 * values.size());
+    return values[std::max<size_t>(rank, 1) - 1];
+}
+
+static void writeResults(std::ostream& out, const char* name, const std::string& map, const std::vector<Scenario>& scenarios,
+                         const std::vector<Result>& results, bool perQuery)
+{
+    std::vector<double> latencies;
+    double expansions = 0;
+    double cost = 0;
+    double suboptimality = 0;
+    double worst = 1;
+    unsigned int solved = 0;
+    unsigned int missed = 0;
+
+    for(unsigned int q = 0; q < results.size(); ++q) {
+        latencies.push_back(results[q].latency);
+        expansions += results[q].expansions;
+
+        if(results[q].solved) {
+            double ratio = scenarios[q].optimal > 0 ? results[q].cost / scenarios[q].optimal : 1;
+            cost += results[q].cost;
+            suboptimality += ratio;
+            worst = std::max(worst, ratio);
+            ++solved;
+        } else if(scenarios[q].optimal > 0) {
+            ++missed;
+        }
+    }
+
+    unsigned int count = std::max<unsigned int>((unsigned int) results.size(), 1);
+
+    out << "    {\n";
+    out << "      \"algorithm\": \"" << name << "\",\n";
+    out << "      \"map\": \"" << map << "\",\n";
+    out << "      \"queries\": " << results.size() << ",\n";
+    out << "      \"solved\": " << solved << ",\n";
+    out << "      \"unsolved\": " << missed << ",\n";
+    out << "      \"latency_us\": { \"p50\": " << percentile(latencies, 50) << ", \"p90\": " << percentile(latencies, 90)
+        << ", \"p99\": " << percentile(latencies, 99) << ", \"max\": " << percentile(latencies, 100) << " },\n";
+    out << "      \"expansions\": { \"total\": " << (uint64_t) expansions << ", \"mean\": " << expansions / count << " },\n";
+    out << "      \"cost\": " << cost << ",\n";
+    out << "      \"suboptimality\": { \"mean\": " << (solved > 0 ? suboptimality / solved : 1) << ", \"max\": " << worst << " }";
+
+    if(perQuery) {
+        out << ",\n      \"results\": [\n";
+
+        for(unsigned int q = 0; q < results.size(); ++q) {
+            out << "        { \"latency_us\": " << results[q].latency << ", \"expansions\": " << results[q].expansions
+                << ", \"cost\": " << (results[q].solved ? results[q].cost : -1) << ", \"optimal\": " << scenarios[q].optimal
+                << " }" << (q + 1 < results.size() ? "," : "") << "\n";
+        }
+
+        out << "      ]";
+    }
+
+    out << "\n    }";
+}
+
+int main(int argc, char const** argv) {
+    std::vector<std::string> files;
+    std::vector<const AlgorithmEntry*> selected;
+    bool perQuery = false;
+
+    for(int a = 1; a < argc; ++a) {
+        if(std::strcmp(argv[a], "--algorithms") == 0 && a + 1 < argc) {
+            std::istringstream names(argv[++a]);
+            std::string name;
+
+            while(std::getline(names, name, ',')) {
+                const AlgorithmEntry* found = nullptr;
+
+                for(unsigned int k = 0; k < algorithmCount; ++k) {
+                    if(name == algorithms[k].name) found = &algorithms[k];
+                }
+
+                if(found == nullptr) {
+                    std::cerr << "unknown algorithm " << name << "\n";
+                    return 1;
+                }
+
+                selected.push_back(found);
+            }
+        } else if(std::strcmp(argv[a], "--queries") == 0) {
+            perQuery = true;
+        } else {
+            files.push_back(argv[a]);
+        }
+    }
+
+    if(files.empty()) {
+        std::cerr << "usage: benchmark [--algorithms astar,greedy,...] [--queries] file.scen...\n";
+        return 1;
+    }
+
+    if(selected.empty()) {
+        for(unsigned int k = 0; k < algorithmCount; ++k) {
+            selected.push_back(&algorithms[k]);
+        }
+    }
+
+    bool failed = false;
+
+    std::cout.precision(6);
+    std::cout << "{\n  \"scenarios\": [\n";
+
+    for(unsigned int f = 0; f < files.size(); ++f) {
+        std::vector<Scenario> scenarios = readScenarios(files[f]);
+        std::vector<Scenario> all = scenarios;
+
+        std::cout << "  {\n  \"file\": \"" << files[f] << "\",\n  \"results\": [\n";
+
+        // Scenarios for the same map are run together so it is loaded once
+        while(!all.empty()) {
+            std::string name = all.front().map;
+            std::vector<Scenario> group;
+
+            for(const Scenario& s : all) {
+                if(s.map == name) group.push_back(s);
+            }
+
+            all.erase(std::remove_if(all.begin(), all.end(), [&](const Scenario& s) { return s.map == name; }), all.end());
+
+            Map map(1, 1);
+            map.cutCorners = false;
+
+            if(!loadMap(directoryOf(files[f]) + name, map) && !loadMap(name, map)) {
+                // The document is already open, so the map gets an entry of its own
+                std::cerr << "can't read map " << name << "\n";
+                std::cout << "    {\n      \"map\": \"" << name << "\",\n      \"error\": \"can't read map\"\n    }"
+                          << (!all.empty() ? ",\n" : "\n");
+                failed = true;
+                continue;
+            }
+
+            for(unsigned int k = 0; k < selected.size(); ++k) {
+                std::unique_ptr<PFAlgorithm> algorithm(selected[k]->make(map));
+                std::vector<Result> results;
+
+                // Untimed, so one-off preprocessing isn't charged to a query
+                algorithm->reset();
+
+                for(const Scenario& s : group) {
+                    map.start = map.index(s.startX, s.startY);
+                    map.goal = map.index(s.goalX, s.goalY);
+
+                    auto begin = std::chrono::steady_clock::now();
+                    algorithm->reset();
+                    algorithm->run(true);
+                    std::vector<unsigned int> path = algorithm->path();
+                    auto end = std::chrono::steady_clock::now();
+
+                    Result result;
+                    result.latency = std::chrono::duration<double, std::micro>(end - begin).count();
+                    result.expansions = algorithm->iterations;
+                    result.cost = length(map, path);
+                    result.solved = !path.empty();
+                    results.push_back(result);
+                }
+
+                writeResults(std::cout, selected[k]->name, name, group, results, perQuery);
+                std::cout << (k + 1 < selected.size() || !all.empty() ? ",\n" : "\n");
+            }
+        }
+
+        std::cout << "  ]\n  }" << (f + 1 < files.size() ? "," : "") << "\n";
+    }
+
+    std::cout << "  ]\n}\n";
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,183 @@
+// Headless searches and map conversion:
+//
+//   pathfinding map startX startY goalX goalY [--algorithm name] [--cut-corners] [--smooth] [--path]
+//   pathfinding --convert in.map out.pfmap [--landmarks count]
+//
+// Maps can be MovingAI .map files or packed .pfmap files.
+
+#include "Algorithms.h"
+#include "ALTStar.h"
+#include "Landmarks.h"
+#include "LineOfSight.h"
+#include "Map.h"
+#include "MapFile.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+static bool endsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Packed maps stay open so their landmark tables can be used
+static bool loadMap(const std::string& path, Map& map, MapFile& file) {
+    if(endsWith(path, ".pfmap")) {
+        return file.open(path) && file.load(map);
+    }
+
+    return MapFile::importMovingAI(path, map);
+}
+
+static int usage() {
+    std::cerr << "usage: pathfinding map startX startY goalX goalY [--algorithm name] [--cut-corners] [--smooth] [--path]\n"
+              << "       pathfinding --convert in.map out.pfmap [--landmarks count]\n"
+              << "algorithms:";
+
+    for(unsigned int k = 0; k < algorithmCount; ++k) {
+        std::cerr << " " << algorithms[k].name;
+    }
+
+    std::cerr << "\n";
+    return 1;
+}
+
+static int convert(int argc, char const** argv) {
+    unsigned int count = 0;
+
+    if(argc < 4) {
+        return usage();
+    }
+
+    if(argc >= 6 && std::strcmp(argv[4], "--landmarks") == 0) {
+        count = (unsigned int) std::atoi(argv[5]);
+    }
+
+    Map map(1, 1);
+    MapFile file;
+    map.cutCorners = false;
+
+    if(!loadMap(argv[2], map, file)) {
+        std::cerr << "can't read " << argv[2] << "\n";
+        return 1;
+    }
+
+    Landmarks landmarks(count);
+
+    if(count > 0) {
+        landmarks.build(map);
+    }
+
+    if(!MapFile::save(argv[3], map, count > 0 ? &landmarks : nullptr)) {
+        std::cerr << "can't write " << argv[3] << "\n";
+        return 1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char const** argv) {
+    if(argc >= 2 && std::strcmp(argv[1], "--convert") == 0) {
+        return convert(argc, argv);
+    }
+
+    if(argc < 6) {
+        return usage();
+    }
+
+    std::string name = "astar";
+    bool printPath = false;
+    bool smooth = false;
+    Map map(1, 1);
+    MapFile file;
+    map.cutCorners = false;
+
+    for(int a = 6; a < argc; ++a) {
+        if(std::strcmp(argv[a], "--algorithm") == 0 && a + 1 < argc) {
+            name = argv[++a];
+        } else if(std::strcmp(argv[a], "--cut-corners") == 0) {
+            map.cutCorners = true;
+        } else if(std::strcmp(argv[a], "--smooth") == 0) {
+            smooth = true;
+        } else if(std::strcmp(argv[a], "--path") == 0) {
+            printPath = true;
+        } else {
+            return usage();
+        }
+    }
+
+    if(!loadMap(argv[1], map, file)) {
+        std::cerr << "can't read " << argv[1] << "\n";
+        return 1;
+    }
+
+    unsigned int coordinates[4];
+
+    for(unsigned int k = 0; k < 4; ++k) {
+        coordinates[k] = (unsigned int) std::atoi(argv[2 + k]);
+    }
+
+    if(coordinates[0] >= map.columns || coordinates[2] >= map.columns ||
+       coordinates[1] >= map.rows || coordinates[3] >= map.rows)
+    {
+        std::cerr << "start or goal is off the map\n";
+        return 1;
+    }
+
+    std::unique_ptr<PFAlgorithm> algorithm(makeAlgorithm(name, map));
+
+    if(algorithm == nullptr) {
+        return usage();
+    }
+
+    if(ALTStar* alt = dynamic_cast<ALTStar*>(algorithm.get())) {
+        file.loadLandmarks(alt->landmarks, map);
+    }
+
+    map.start = map.index(coordinates[0], coordinates[1]);
+    map.goal = map.index(coordinates[2], coordinates[3]);
+
+    if(map.wall(map.start) || map.wall(map.goal)) {
+        std::cerr << "start or goal is a wall\n";
+        return 1;
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    algorithm->reset();
+    algorithm->run(true);
+    std::vector<unsigned int> path = algorithm->path();
+
+    if(smooth) {
+        path = pullString(map, path);
+    }
+
+    auto end = std::chrono::steady_clock::now();
+
+    // Any-angle paths and pulled strings skip between cells that aren't
+    // neighbours
+    unsigned int cost = 0;
+
+    for(unsigned int k = 1; k < path.size(); ++k) {
+        bool adjacent = std::abs((int) map.column(path[k - 1]) - (int) map.column(path[k])) <= 1 &&
+                        std::abs((int) map.row(path[k - 1]) - (int) map.row(path[k])) <= 1;
+        cost += adjacent ? map.movCost(path[k - 1], path[k]) : lineLength(map, path[k - 1], path[k]);
+    }
+
+    std::cout << "algorithm " << name << "\n"
+              << "found " << (path.empty() ? "no" : "yes") << "\n"
+              << "cost " << cost << "\n"
+              << "length " << path.size() << "\n"
+              << "expansions " << algorithm->iterations << "\n"
+              << "time_us " << std::chrono::duration<double, std::micro>(end - begin).count() << "\n";
+
+    if(printPath) {
+        for(unsigned int node : path) {
+            std::cout << map.column(node) << " " << map.row(node) << "\n";
+        }
+    }
+
+    return path.empty() ? 2 : 0;
+}
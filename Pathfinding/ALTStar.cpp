@@ -0,0 +1,21 @@
+#include "ALTStar.h"
+#include "Heuristic.h"
+#include <algorithm>
+
+void ALTStar::reset() {
+    PFAlgorithm::reset();
+
+    if(landmarks.stale(map)) {
+        landmarks.build(map);
+    }
+
+    start([this](unsigned int node) { return ALTStar::heuristic(node); });
+}
+
+void ALTStar::run(bool toEnd) {
+    expand(toEnd, [this](unsigned int node) { return ALTStar::heuristic(node); });
+}
+
+unsigned int ALTStar::heuristic(unsigned int node) const {
+    return std::max(estimate<Octile>(map, node, map.goal), landmarks.lowerBound(node, map.goal));
+}
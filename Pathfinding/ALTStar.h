@@ -0,0 +1,21 @@
+#ifndef __Pathfinding__ALTStar__
+#define __Pathfinding__ALTStar__
+
+#include "Landmarks.h"
+#include "Search.h"
+
+// A* with the larger of the octile distance and the landmark bound as its
+// heuristic. The tables are built on the first query and rebuilt lazily, only
+// before a query that follows an edit opening up new moves.
+class ALTStar : public AStar {
+public:
+    ALTStar(Map& map, unsigned int landmarks = 8) : AStar(map), landmarks(landmarks) {}
+
+    virtual void reset();
+    virtual void run(bool toEnd);
+    virtual unsigned int heuristic(unsigned int node) const;
+
+    Landmarks landmarks;
+};
+
+#endif /* defined(__Pathfinding__ALTStar__) */
@@ -0,0 +1,34 @@
+#include "Algorithms.h"
+#include "DStarLite.h"
+#include "JPS.h"
+#include "HPAStar.h"
+#include "ALTStar.h"
+#include "BidirectionalAStar.h"
+#include "FlowField.h"
+#include "ThetaStar.h"
+
+// New algorithms only need an entry here
+const AlgorithmEntry algorithms[] = {
+    { "astar", [](Map& map) -> PFAlgorithm* { return new AStar(map); } },
+    { "greedy", [](Map& map) -> PFAlgorithm* { return new Greedy(map); } },
+    { "dstarlite", [](Map& map) -> PFAlgorithm* { return new DStarLite(map); } },
+    { "jps", [](Map& map) -> PFAlgorithm* { return new JPS(map); } },
+    { "hpastar", [](Map& map) -> PFAlgorithm* { return new HPAStar(map); } },
+    { "alt", [](Map& map) -> PFAlgorithm* { return new ALTStar(map); } },
+    { "bidirectional", [](Map& map) -> PFAlgorithm* { return new BidirectionalAStar(map); } },
+    { "flowfield", [](Map& map) -> PFAlgorithm* { return new FlowField(map); } },
+    { "theta", [](Map& map) -> PFAlgorithm* { return new ThetaStar(map); } },
+    { "lazytheta", [](Map& map) -> PFAlgorithm* { return new ThetaStar(map, true); } },
+};
+
+const unsigned int algorithmCount = sizeof(algorithms) / sizeof(algorithms[0]);
+
+PFAlgorithm* makeAlgorithm(const std::string& name, Map& map) {
+    for(unsigned int k = 0; k < algorithmCount; ++k) {
+        if(name == algorithms[k].name) {
+            return algorithms[k].make(map);
+        }
+    }
+
+    return nullptr;
+}
@@ -0,0 +1,19 @@
+#ifndef __Pathfinding__Algorithms__
+#define __Pathfinding__Algorithms__
+
+#include "Search.h"
+#include <string>
+
+// The searches by name, for the command-line tools
+struct AlgorithmEntry {
+    const char* name;
+    PFAlgorithm* (*make)(Map& map);
+};
+
+extern const AlgorithmEntry algorithms[];
+extern const unsigned int algorithmCount;
+
+// Returns nullptr for an unknown name
+PFAlgorithm* makeAlgorithm(const std::string& name, Map& map);
+
+#endif /* defined(__Pathfinding__Algorithms__) */
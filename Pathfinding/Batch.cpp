@@ -0,0 +1,115 @@
+#include "Batch.h"
+#include "Heuristic.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+// Queries are handed out in chunks so workers rarely touch the shared counter
+static const unsigned int chunkSize = 16;
+
+Batch::Batch(const Map& map, unsigned int threads)
+: map(map),
+  threads(threads)
+{
+    if(this->threads == 0) {
+        this->threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+std::vector<std::vector<unsigned int> > Batch::run(const std::vector<Query>& queries) {
+    std::vector<std::vector<unsigned int> > paths(queries.size());
+    unsigned int workers = std::min(threads, (unsigned int) (queries.size() + chunkSize - 1) / chunkSize);
+    std::atomic<unsigned int> next(0);
+
+    // Workers only read the labels
+    map.updateComponents();
+
+    if(scratch.size() < workers) {
+        scratch.resize(workers);
+    }
+
+    for(unsigned int w = 0; w < workers; ++w) {
+        Scratch& s = scratch[w];
+
+        if(s.search.size() != map.size()) {
+            s.openList.resize(map.size());
+        }
+    }
+
+    auto work = [&](Scratch& s) {
+        while(true) {
+            unsigned int first = next.fetch_add(chunkSize);
+
+            if(first >= queries.size()) {
+                return;
+            }
+
+            unsigned int last = std::min(first + chunkSize, (unsigned int) queries.size());
+
+            for(unsigned int q = first; q < last; ++q) {
+                search(s, queries[q], paths[q]);
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+
+    for(unsigned int w = 1; w < workers; ++w) {
+        pool.push_back(std::thread(work, std::ref(scratch[w])));
+    }
+
+    if(workers > 0) {
+        work(scratch[0]);
+    }
+
+    for(std::thread& thread : pool) {
+        thread.join();
+    }
+
+    return paths;
+}
+
+void Batch::search(Scratch& s, const Query& query, std::vector<unsigned int>& path) const {
+    s.search.clear(map.size());
+    s.openList.clear();
+
+    if(!map.connected(query.start, query.goal)) {
+        return;
+    }
+
+    unsigned int h = estimate<Octile>(map, query.start, query.goal);
+    s.search.touch(query.start).gCost = 0;
+    s.openList.push(query.start, ((uint64_t) h << 32) | h);
+
+    while(!s.openList.empty()) {
+        unsigned int current = s.openList.pop();
+
+        if(current == query.goal) {
+            for(unsigned int node = current; node != Map::none; node = s.search.cameFrom(node)) {
+                path.push_back(node);
+            }
+
+            std::reverse(path.begin(), path.end());
+            return;
+        }
+
+        s.search.touch(current).closed = true;
+
+        map.forEachNeighbour(current, [&](unsigned int neighbour, unsigned int cost) {
+            if(s.search.closed(neighbour)) {
+                return;
+            }
+
+            unsigned int newCost = s.search.gCost(current) + cost;
+
+            if(newCost < s.search.gCost(neighbour)) {
+                unsigned int h = estimate<Octile>(map, neighbour, query.goal);
+                Workspace::Cell& cell = s.search.touch(neighbour);
+                cell.gCost = newCost;
+                cell.fCost = newCost + h;
+                cell.cameFrom = current;
+                s.openList.push(neighbour, ((uint64_t) (newCost + h) << 32) | h);
+            }
+        });
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef __Pathfinding__Batch__
+#define __Pathfinding__Batch__
+
+#include "Map.h"
+#include "OpenList.h"
+#include "Workspace.h"
+#include <vector>
+
+struct Query {
+    unsigned int start;
+    unsigned int goal;
+};
+
+// Answers many start/goal queries at once with A* on a pool of threads.
+// Workers only read the map's walls, so it must not be edited while a batch
+// runs. Search state lives in per-thread workspaces kept between batches.
+class Batch {
+public:
+    // No thread count means one per hardware thread
+    Batch(const Map& map, unsigned int threads = 0);
+
+    // Returns a path from start to goal for each query, or an empty one if
+    // the goal can't be reached
+    std::vector<std::vector<unsigned int> > run(const std::vector<Query>& queries);
+
+    const Map& map;
+    unsigned int threads;
+
+private:
+    struct Scratch {
+        OpenList openList;
+        Workspace search;
+    };
+
+    void search(Scratch& scratch, const Query& query, std::vector<unsigned int>& path) const;
+
+    std::vector<Scratch> scratch;
+};
+
+#endif /* defined(__Pathfinding__Batch__) */
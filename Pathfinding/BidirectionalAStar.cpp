@@ -0,0 +1,123 @@
+#include "BidirectionalAStar.h"
+#include "Heuristic.h"
+
+void BidirectionalAStar::reset() {
+    PFAlgorithm::reset();
+
+    if(backward.size() != map.size()) {
+        backwardOpen.resize(map.size());
+    } else {
+        backwardOpen.clear();
+    }
+
+    backward.clear(map.size());
+    best = Map::infinity;
+    meeting = Map::none;
+    joined = false;
+
+    if(!map.connected(map.start, map.goal)) {
+        return;
+    }
+
+    unsigned int h = estimate<Octile>(map, map.start, map.goal);
+    Workspace::Cell& start = search.touch(map.start);
+    start.gCost = 0;
+    start.fCost = h;
+    open(map.start, ((uint64_t) h << 32) | h);
+
+    Workspace::Cell& goal = backward.touch(map.goal);
+    goal.gCost = 0;
+    goal.fCost = h;
+    backwardOpen.push(map.goal, ((uint64_t) h << 32) | h);
+    trace.record(Trace::opened, map.goal, Map::none, 0, h);
+
+    if(map.start == map.goal) {
+        best = 0;
+        meeting = map.start;
+    }
+}
+
+void BidirectionalAStar::run(bool toEnd) {
+    while(!finished() && (iterations < iteration || toEnd)) {
+        if(openList.size() <= backwardOpen.size()) {
+            expand(openList, search, backward, map.goal);
+        } else {
+            expand(backwardOpen, backward, search, map.start);
+        }
+
+        ++iterations;
+    }
+
+    if(finished() && !joined) {
+        join();
+    }
+
+    if(toEnd) {
+        iteration = iterations;
+    }
+}
+
+// Either side running dry means every cell it can reach is done. Otherwise
+// no path through a frontier can beat the best one once the frontier's
+// smallest f does.
+bool BidirectionalAStar::finished() const {
+    if(openList.empty() || backwardOpen.empty()) {
+        return true;
+    }
+
+    return best != Map::infinity &&
+           ((openList.topKey() >> 32) >= best || (backwardOpen.topKey() >> 32) >= best);
+}
+
+void BidirectionalAStar::expand(OpenList& frontier, Workspace& side, const Workspace& other, unsigned int target) {
+    current = frontier.pop();
+    side.touch(current).closed = true;
+    trace.step(current);
+    trace.record(Trace::closed, current, side.cameFrom(current), side.gCost(current), side.fCost(current));
+
+    map.forEachNeighbour(current, [&](unsigned int neighbour, unsigned int cost) {
+        if(side.closed(neighbour)) {
+            return;
+        }
+
+        unsigned int newCost = side.gCost(current) + cost;
+
+        if(newCost >= side.gCost(neighbour)) {
+            return;
+        }
+
+        unsigned int h = estimate<Octile>(map, neighbour, target);
+        Trace::Type type = frontier.contains(neighbour) ? Trace::relaxed : Trace::opened;
+        Workspace::Cell& cell = side.touch(neighbour);
+        cell.gCost = newCost;
+        cell.fCost = newCost + h;
+        cell.cameFrom = current;
+        frontier.push(neighbour, ((uint64_t) cell.fCost << 32) | h);
+        trace.record(type, neighbour, current, newCost, cell.fCost);
+
+        if(other.gCost(neighbour) != Map::infinity && newCost + other.gCost(neighbour) < best) {
+            best = newCost + other.gCost(neighbour);
+            meeting = neighbour;
+        }
+    });
+}
+
+// Follows the backward parents from the meeting cell to the goal, pointing
+// each one back along the path instead
+void BidirectionalAStar::join() {
+    joined = true;
+
+    if(meeting == Map::none) {
+        return;
+    }
+
+    for(unsigned int node = meeting; node != map.goal; ) {
+        unsigned int next = backward.cameFrom(node);
+        Workspace::Cell& cell = search.touch(next);
+        cell.cameFrom = node;
+        cell.gCost = best - backward.gCost(next);
+        node = next;
+    }
+
+    current = map.goal;
+}
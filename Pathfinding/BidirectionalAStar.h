@@ -0,0 +1,38 @@
+#ifndef __Pathfinding__BidirectionalAStar__
+#define __Pathfinding__BidirectionalAStar__
+
+#include "Search.h"
+#include <vector>
+
+// A* from the start and from the goal at once, each side with the octile
+// distance to the other end as its heuristic. Each iteration expands the side
+// with the smaller frontier, so a boxed-in start or goal runs out of nodes
+// after a few expansions and the search gives up.
+//
+// The best path seen through a cell both sides reached is kept; it is optimal
+// once either frontier's smallest key reaches its cost. The backward parents
+// are then spliced into cameFrom, so path() works as for AStar.
+class BidirectionalAStar : public PFAlgorithm {
+public:
+    BidirectionalAStar(Map& map) : PFAlgorithm(map), best(Map::infinity), meeting(Map::none), joined(false) {}
+
+    virtual void reset();
+    virtual void run(bool toEnd);
+
+    // Search state of the side going from the goal back to the start
+    OpenList backwardOpen;
+    Workspace backward;
+
+    // Cost of the best path found so far and the cell where it meets
+    unsigned int best;
+    unsigned int meeting;
+
+private:
+    bool finished() const;
+    void expand(OpenList& frontier, Workspace& side, const Workspace& other, unsigned int target);
+    void join();
+
+    bool joined;
+};
+
+#endif /* defined(__Pathfinding__BidirectionalAStar__) */
@@ -0,0 +1,101 @@
+#ifndef __Pathfinding__Bitset__
+#define __Pathfinding__Bitset__
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// The index of the lowest set bit of a nonzero word, by de Bruijn
+// multiplication
+inline unsigned int lowestBit(uint64_t word) {
+    static const unsigned char table[64] = {
+         0,  1,  2, 53,  3,  7, 54, 27,  4, 38, 41,  8, 34, 55, 48, 28,
+        62,  5, 39, 46, 44, 42, 22,  9, 24, 35, 59, 56, 49, 18, 29, 11,
+        63, 52,  6, 26, 37, 40, 33, 47, 61, 45, 43, 21, 23, 58, 17, 10,
+        51, 25, 36, 32, 60, 20, 57, 16, 50, 31, 19, 15, 30, 14, 13, 12
+    };
+
+    return table[((word & (0 - word)) * 0x022FDD63CC95386DULL) >> 58];
+}
+
+// The number of set bits, summed in parallel within the word. Compilers turn
+// this into a single instruction where there is one.
+inline unsigned int bitCount(uint64_t word) {
+    word -= (word >> 1) & 0x5555555555555555ULL;
+    word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (unsigned int) ((word * 0x0101010101010101ULL) >> 56);
+}
+
+// 64-bit words that are either owned or a view of memory kept alive by
+// someone else, such as a mapped file. Copies always own their words.
+class Bitset {
+public:
+    Bitset() : bits(nullptr), words(0) {}
+    Bitset(const Bitset& other) { *this = other; }
+
+    Bitset& operator=(const Bitset& other) {
+        if(this != &other) {
+            owned.assign(other.begin(), other.end());
+            owner.reset();
+            bits = owned.data();
+            words = other.words;
+        }
+
+        return *this;
+    }
+
+    void assign(unsigned int count, uint64_t value) {
+        owned.assign(count, value);
+        owner.reset();
+        bits = owned.data();
+        words = count;
+    }
+
+    // The owner is held for as long as the view is
+    void view(uint64_t* data, unsigned int count, std::shared_ptr<void> keeper) {
+        std::vector<uint64_t>().swap(owned);
+        owner = keeper;
+        bits = data;
+        words = count;
+    }
+
+    bool viewing() const { return owner != nullptr; }
+
+    // Sets or clears bits [first, last) a word at a time. Returns whether any
+    // of them changed.
+    bool fill(unsigned int first, unsigned int last, bool value) {
+        uint64_t changed = 0;
+
+        while(first < last) {
+            unsigned int word = first >> 6;
+            unsigned int low = first & 63;
+            unsigned int high = std::min(last - word * 64, 64u);
+            uint64_t mask = (high == 64 ? ~(uint64_t) 0 : ((uint64_t) 1 << high) - 1) & (~(uint64_t) 0 << low);
+            uint64_t updated = value ? bits[word] | mask : bits[word] & ~mask;
+
+            changed |= updated ^ bits[word];
+            bits[word] = updated;
+            first = word * 64 + high;
+        }
+
+        return changed != 0;
+    }
+
+    unsigned int size() const { return words; }
+    uint64_t* data() { return bits; }
+    const uint64_t* data() const { return bits; }
+    const uint64_t* begin() const { return bits; }
+    const uint64_t* end() const { return bits + words; }
+    uint64_t& operator[](unsigned int word) { return bits[word]; }
+    uint64_t operator[](unsigned int word) const { return bits[word]; }
+
+private:
+    uint64_t* bits;
+    unsigned int words;
+    std::vector<uint64_t> owned;
+    std::shared_ptr<void> owner;
+};
+
+#endif /* defined(__Pathfinding__Bitset__) */
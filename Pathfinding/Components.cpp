@@ -0,0 +1,151 @@
+#include "Components.h"
+#include "Map.h"
+
+void Components::update(const Map& map) {
+    if(!dirty && cutCorners == map.cutCorners && element.size() == map.size()) {
+        return;
+    }
+
+    element.resize(map.size());
+    parent.resize(map.size());
+    size.assign(map.size(), 1);
+
+    for(unsigned int node = 0; node < map.size(); ++node) {
+        element[node] = node;
+        parent[node] = node;
+    }
+
+    for(unsigned int node = 0; node < map.size(); ++node) {
+        if(!map.wall(node)) {
+            map.forEachNeighbour(node, [&](unsigned int neighbour, unsigned int) {
+                if(neighbour > node) {
+                    join(node, neighbour);
+                }
+            });
+        }
+    }
+
+    dirty = false;
+    cutCorners = map.cutCorners;
+}
+
+// The only moves a new wall takes away are its own and the diagonals past
+// its corners, all between cells around it. If those cells still reach each
+// other without it, no region is split.
+void Components::wallAdded(const Map& map, unsigned int node) {
+    if(dirty) {
+        return;
+    }
+
+    int i = map.column(node);
+    int j = map.row(node);
+    unsigned int around[8];
+    unsigned int count = 0;
+
+    for(unsigned int d = 0; d < 8; ++d) {
+        int ni = i + Map::directionI[d];
+        int nj = j + Map::directionJ[d];
+
+        if(ni >= 0 && nj >= 0 && ni < (int) map.columns && nj < (int) map.rows && !map.wall(map.index(ni, nj))) {
+            around[count++] = map.index(ni, nj);
+        }
+    }
+
+    if(count < 2) {
+        return;
+    }
+
+    // Flood the free cells around the wall, without leaving them
+    bool reached[8] = { true };
+    unsigned int stack[8] = { 0 };
+    unsigned int top = 1;
+    unsigned int found = 1;
+
+    while(top > 0) {
+        unsigned int from = around[stack[--top]];
+
+        map.forEachNeighbour(from, [&](unsigned int neighbour, unsigned int) {
+            for(unsigned int k = 0; k < count; ++k) {
+                if(around[k] == neighbour && !reached[k]) {
+                    reached[k] = true;
+                    stack[top++] = k;
+                    ++found;
+                }
+            }
+        });
+    }
+
+    if(found < count) {
+        dirty = true;
+    }
+}
+
+// Past two elements a cell, relabelling costs less than the memory the
+// elements of old walls keep
+void Components::wallRemoved(const Map& map, unsigned int node) {
+    if(dirty) {
+        return;
+    }
+
+    if(parent.size() >= 2 * (size_t) map.size()) {
+        dirty = true;
+        return;
+    }
+
+    element[node] = (unsigned int) parent.size();
+    parent.push_back(element[node]);
+    size.push_back(1);
+
+    map.forEachNeighbour(node, [&](unsigned int neighbour, unsigned int) {
+        join(node, neighbour);
+    });
+}
+
+bool Components::connected(const Map& map, unsigned int a, unsigned int b) const {
+    if(map.wall(a) || map.wall(b)) {
+        return false;
+    }
+
+    if(dirty || cutCorners != map.cutCorners || element.size() != map.size()) {
+        return true;
+    }
+
+    return find(element[a]) == find(element[b]);
+}
+
+unsigned int Components::find(unsigned int e) const {
+    while(parent[e] != e) {
+        e = parent[e];
+    }
+
+    return e;
+}
+
+unsigned int Components::compress(unsigned int e) {
+    unsigned int root = find(e);
+
+    while(parent[e] != root) {
+        unsigned int next = parent[e];
+        parent[e] = root;
+        e = next;
+    }
+
+    return root;
+}
+
+// Joins the regions of two cells, the smaller under the larger
+void Components::join(unsigned int a, unsigned int b) {
+    unsigned int rootA = compress(element[a]);
+    unsigned int rootB = compress(element[b]);
+
+    if(rootA == rootB) {
+        return;
+    }
+
+    if(size[rootA] < size[rootB]) {
+        std::swap(rootA, rootB);
+    }
+
+    parent[rootB] = rootA;
+    size[rootA] += size[rootB];
+}
@@ -0,0 +1,44 @@
+#ifndef __Pathfinding__Components__
+#define __Pathfinding__Components__
+
+#include <vector>
+
+class Map;
+
+// Connected regions of free cells, kept in a union-find as walls change.
+// Removing a wall merges the regions around it. Adding one can only split a
+// region if the free cells around it no longer connect to each other; then
+// the labels are rebuilt before the next query.
+//
+// A freed cell gets a new element, so the elements of cells that became
+// walls stay in place for the cells linked through them. Once there are twice
+// as many elements as cells the labels are rebuilt instead.
+class Components {
+public:
+    Components() : dirty(true), cutCorners(false) {}
+
+    // Relabels the map if an edit may have split a region
+    void update(const Map& map);
+    void wallAdded(const Map& map, unsigned int node);
+    void wallRemoved(const Map& map, unsigned int node);
+
+    // For walls written straight into the bitset
+    void invalidate() { dirty = true; }
+
+    // Conservative while the labels are out of date: only a pair known to
+    // be apart is reported as not connected
+    bool connected(const Map& map, unsigned int a, unsigned int b) const;
+
+private:
+    unsigned int find(unsigned int element) const;
+    unsigned int compress(unsigned int element);
+    void join(unsigned int a, unsigned int b);
+
+    std::vector<unsigned int> element;
+    std::vector<unsigned int> parent;
+    std::vector<unsigned int> size;
+    bool dirty;
+    bool cutCorners;
+};
+
+#endif /* defined(__Pathfinding__Components__) */
@@ -0,0 +1,239 @@
+#include "DStarLite.h"
+#include "Heuristic.h"
+#include <algorithm>
+
+void DStarLite::reset() {
+    PFAlgorithm::reset();
+    rhs.resize(map.size());
+
+    km = 0;
+    lastStart = map.start;
+    touch(map.goal);
+    rhs[map.goal] = 0;
+    open(map.goal, key(map.goal));
+}
+
+// Planning towards a start the goal can't reach is put off until an edit
+// joins them; the tree built so far is kept
+void DStarLite::run(bool toEnd) {
+    map.updateComponents();
+
+    if(!map.connected(map.start, map.goal)) {
+        if(toEnd) {
+            iteration = iterations;
+        }
+
+        return;
+    }
+
+    while(!openList.empty() && (iterations < iteration || toEnd)) {
+        unsigned int start = map.start;
+
+        if(openList.topKey() >= key(start) && rhsOf(start) == search.gCost(start)) {
+            break;
+        }
+
+        current = openList.top();
+        uint64_t oldKey = openList.topKey();
+        uint64_t newKey = key(current);
+
+        if(oldKey < newKey) {
+            openList.push(current, newKey);
+            continue;
+        }
+
+        if(search.gCost(current) > rhs[current]) {
+            touch(current).gCost = rhs[current];
+            openList.pop();
+            close(current);
+        } else {
+            trace.step(current);
+            touch(current).gCost = Map::infinity;
+            updateVertex(current);
+        }
+
+        map.forEachNeighbour(current, [this](unsigned int neighbour, unsigned int) {
+            updateVertex(neighbour);
+        });
+
+        ++iterations;
+    }
+
+    if(toEnd) {
+        iteration = iterations;
+    }
+}
+
+// Walks down the cost-to-goal gradient from the start
+std::vector<unsigned int> DStarLite::path() {
+    std::vector<unsigned int> cells;
+    unsigned int node = map.start;
+
+    if(rhs.size() != map.size() || search.gCost(node) == Map::infinity) {
+        return cells;
+    }
+
+    cells.push_back(node);
+
+    while(node != map.goal) {
+        unsigned int best = Map::infinity;
+        unsigned int next = Map::none;
+
+        map.forEachNeighbour(node, [&](unsigned int neighbour, unsigned int cost) {
+            if(search.gCost(neighbour) != Map::infinity && search.gCost(neighbour) + cost < best) {
+                best = search.gCost(neighbour) + cost;
+                next = neighbour;
+            }
+        });
+
+        if(next == Map::none || cells.size() > map.size()) {
+            return std::vector<unsigned int>();
+        }
+
+        node = next;
+        cells.push_back(node);
+    }
+
+    return cells;
+}
+
+void DStarLite::wallChanged(unsigned int node) {
+    if(rhs.size() != map.size()) {
+        rebuild();
+        return;
+    }
+
+    updateAround(node);
+    run(true);
+    trace.seek(iteration);
+}
+
+// A batch of walls touches the same cells as a cost change over its region
+void DStarLite::wallsChanged(unsigned int i0, unsigned int j0, unsigned int i1, unsigned int j1) {
+    costsChanged(i0, j0, i1, j1);
+}
+
+void DStarLite::startChanged() {
+    if(rhs.size() != map.size()) {
+        rebuild();
+        return;
+    }
+
+    km += distance(lastStart, map.start);
+    lastStart = map.start;
+    run(true);
+    trace.seek(iteration);
+}
+
+void DStarLite::goalChanged() {
+    rebuild();
+}
+
+// Runs to the end like the repairs. replan() would stop at the iteration
+// being shown, which is 0 before the first step, and after moving the goal
+// onto a wall is where the repair of the old tree ended.
+void DStarLite::rebuild() {
+    reset();
+    run(true);
+    trace.seek(iteration);
+}
+
+// A cell's cost is part of every edge it has, so the cells of the region and
+// the ring around it are updated
+void DStarLite::costsChanged(unsigned int i0, unsigned int j0, unsigned int i1, unsigned int j1) {
+    if(rhs.size() != map.size()) {
+        rebuild();
+        return;
+    }
+
+    unsigned int iEnd = std::min(i1 + 1, map.columns);
+    unsigned int jEnd = std::min(j1 + 1, map.rows);
+
+    for(unsigned int j = j0 > 0 ? j0 - 1 : 0; j < jEnd; ++j) {
+        for(unsigned int i = i0 > 0 ? i0 - 1 : 0; i < iEnd; ++i) {
+            updateVertex(map.index(i, j));
+        }
+    }
+
+    run(true);
+    trace.seek(iteration);
+}
+
+unsigned int DStarLite::rhsOf(unsigned int node) const {
+    return search.visited(node) ? rhs[node] : Map::infinity;
+}
+
+// Brings a cell into the search, its rhs included
+Workspace::Cell& DStarLite::touch(unsigned int node) {
+    if(!search.visited(node)) {
+        rhs[node] = Map::infinity;
+    }
+
+    return search.touch(node);
+}
+
+// The search runs from the goal, so estimates are to the start
+unsigned int DStarLite::heuristic(unsigned int node) const {
+    return distance(map.start, node);
+}
+
+unsigned int DStarLite::distance(unsigned int n1, unsigned int n2) const {
+    return estimate<Octile>(map, n1, n2);
+}
+
+uint64_t DStarLite::key(unsigned int node) {
+    unsigned int cost = std::min(search.gCost(node), rhsOf(node));
+
+    if(cost == Map::infinity) {
+        return UINT64_MAX;
+    }
+
+    uint64_t k1 = (uint64_t) cost + distance(map.start, node) + km;
+    return (k1 << 32) | cost;
+}
+
+void DStarLite::updateVertex(unsigned int node) {
+    if(node != map.goal) {
+        unsigned int best = Map::infinity;
+        unsigned int next = Map::none;
+
+        if(!map.wall(node)) {
+            map.forEachNeighbour(node, [&](unsigned int neighbour, unsigned int cost) {
+                if(search.gCost(neighbour) != Map::infinity && search.gCost(neighbour) + cost < best) {
+                    best = search.gCost(neighbour) + cost;
+                    next = neighbour;
+                }
+            });
+        }
+
+        touch(node).cameFrom = next;
+        rhs[node] = best;
+    }
+
+    if(search.gCost(node) != rhsOf(node)) {
+        uint64_t nodeKey = key(node);
+        touch(node).fCost = (unsigned int) (nodeKey >> 32);
+        open(node, nodeKey);
+    } else if(openList.contains(node)) {
+        openList.remove(node);
+        record(search.closed(node) ? Trace::closed : Trace::removed, node);
+    }
+}
+
+// A wall edit changes the edges of the cell itself and of the eight cells
+// around it, diagonals passing its corners included
+void DStarLite::updateAround(unsigned int node) {
+    int i = map.column(node);
+    int j = map.row(node);
+
+    updateVertex(node);
+
+    for(unsigned int d = 0; d < 8; ++d) {
+        int ni = i + Map::directionI[d];
+        int nj = j + Map::directionJ[d];
+
+        if(ni >= 0 && nj >= 0 && ni < (int) map.columns && nj < (int) map.rows) {
+            updateVertex(map.index(ni, nj));
+        }
+    }
+}
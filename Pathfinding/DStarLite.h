@@ -0,0 +1,47 @@
+#ifndef __Pathfinding__DStarLite__
+#define __Pathfinding__DStarLite__
+
+#include "Search.h"
+#include <vector>
+
+// D* Lite searches backwards from the goal and keeps its search tree between
+// runs. Wall edits and start moves only repair the vertices they made
+// inconsistent; moving the goal still replans from scratch. Either way it
+// runs to the end.
+//
+// gCost holds the cost to the goal and cameFrom the next cell towards it.
+class DStarLite : public PFAlgorithm {
+public:
+    DStarLite(Map& map)
+    : PFAlgorithm(map),
+    lastStart(Map::none),
+    km(0)
+    {}
+
+    virtual void reset();
+    virtual void run(bool toEnd);
+    virtual std::vector<unsigned int> path();
+    virtual void wallChanged(unsigned int node);
+    virtual void wallsChanged(unsigned int i0, unsigned int j0, unsigned int i1, unsigned int j1);
+    virtual void startChanged();
+    virtual void goalChanged();
+    virtual void costsChanged(unsigned int i0, unsigned int j0, unsigned int i1, unsigned int j1);
+    virtual unsigned int heuristic(unsigned int node) const;
+
+    // One-step lookahead costs, valid for the cells the search has visited
+    std::vector<unsigned int> rhs;
+
+private:
+    unsigned int rhsOf(unsigned int node) const;
+    Workspace::Cell& touch(unsigned int node);
+    unsigned int distance(unsigned int n1, unsigned int n2) const;
+    uint64_t key(unsigned int node);
+    void updateVertex(unsigned int node);
+    void updateAround(unsigned int node);
+    void rebuild();
+
+    unsigned int lastStart;
+    unsigned int km;
+};
+
+#endif /* defined(__Pathfinding__DStarLite__) */
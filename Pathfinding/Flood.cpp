@@ -0,0 +1,193 @@
+#include "Flood.h"
+#include "Bitset.h"
+#include <algorithm>
+
+// A row shifted one cell east or west, carrying bits across words. The masked
+// versions shift only the cells also set in the mask.
+static inline uint64_t east(const uint64_t* row, unsigned int w) {
+    return (row[w] << 1) | (w > 0 ? row[w - 1] >> 63 : 0);
+}
+
+static inline uint64_t west(const uint64_t* row, unsigned int w, unsigned int words) {
+    return (row[w] >> 1) | (w + 1 < words ? row[w + 1] << 63 : 0);
+}
+
+static inline uint64_t east(const uint64_t* row, const uint64_t* mask, unsigned int w) {
+    return ((row[w] & mask[w]) << 1) | (w > 0 ? (row[w - 1] & mask[w - 1]) >> 63 : 0);
+}
+
+static inline uint64_t west(const uint64_t* row, const uint64_t* mask, unsigned int w, unsigned int words) {
+    return ((row[w] & mask[w]) >> 1) | (w + 1 < words ? (row[w + 1] & mask[w + 1]) << 63 : 0);
+}
+
+Flood::Flood(const Map& map)
+: map(map),
+  rows(0),
+  columns(0),
+  wordsPerRow(0)
+{
+    update();
+}
+
+void Flood::update() {
+    rows = map.rows;
+    columns = map.columns;
+    wordsPerRow = (columns + 63) / 64;
+
+    open.assign((size_t) rows * wordsPerRow, 0);
+    visited.assign(open.size(), 0);
+    frontier.assign(open.size(), 0);
+    next.assign(open.size(), 0);
+    i0 = j0 = 0;
+    i1 = j1 = 0;
+
+    for(unsigned int j = 0; j < rows; ++j) {
+        uint64_t* row = &open[(size_t) j * wordsPerRow];
+
+        for(unsigned int i = 0; i < columns; ++i) {
+            if(!map.wall(map.index(i, j))) {
+                row[i >> 6] |= (uint64_t) 1 << (i & 63);
+            }
+        }
+    }
+}
+
+unsigned int Flood::run(const std::vector<unsigned int>& sources, unsigned int maxSteps) {
+    return flood(sources, maxSteps, Map::none, [](unsigned int, uint64_t, unsigned int) {});
+}
+
+unsigned int Flood::distances(const std::vector<unsigned int>& sources, std::vector<unsigned int>& distance,
+                              unsigned int maxSteps)
+{
+    distance.assign(map.size(), Map::infinity);
+
+    return flood(sources, maxSteps, Map::none, [&](unsigned int first, uint64_t cells, unsigned int step) {
+        while(cells != 0) {
+            distance[first + lowestBit(cells)] = step;
+            cells &= cells - 1;
+        }
+    });
+}
+
+bool Flood::connected(unsigned int start, unsigned int goal) {
+    std::vector<unsigned int> sources(1, start);
+    flood(sources, Map::infinity, goal, [](unsigned int, uint64_t, unsigned int) {});
+    return reached(goal);
+}
+
+// Calls visit(first cell, bits, step) for every word of newly reached cells.
+// Stops early once the target is reached.
+template<typename Visitor>
+unsigned int Flood::flood(const std::vector<unsigned int>& sources, unsigned int maxSteps, unsigned int target,
+                          Visitor visit)
+{
+    if(rows != map.rows || columns != map.columns) {
+        update();
+    }
+
+    // Clear what the last flood left behind
+    for(unsigned int j = j0; j <= j1 && j < rows; ++j) {
+        size_t first = (size_t) j * wordsPerRow + (i0 >> 6);
+        size_t last = (size_t) j * wordsPerRow + (i1 >> 6);
+        std::fill(visited.begin() + first, visited.begin() + last + 1, 0);
+        std::fill(frontier.begin() + first, frontier.begin() + last + 1, 0);
+        std::fill(next.begin() + first, next.begin() + last + 1, 0);
+    }
+
+    unsigned int count = 0;
+    i0 = j0 = Map::infinity;
+    i1 = j1 = 0;
+
+    for(unsigned int source : sources) {
+        unsigned int i = source % columns;
+        unsigned int j = source / columns;
+        size_t word = (size_t) j * wordsPerRow + (i >> 6);
+        uint64_t bit = (uint64_t) 1 << (i & 63);
+
+        if((open[word] & bit) && !(visited[word] & bit)) {
+            visited[word] |= bit;
+            frontier[word] |= bit;
+            visit(j * columns + (i & ~63u), bit, 0);
+            ++count;
+        }
+
+        i0 = std::min(i0, i);
+        j0 = std::min(j0, j);
+        i1 = std::max(i1, i);
+        j1 = std::max(j1, j);
+    }
+
+    if(count == 0) {
+        i0 = j0 = i1 = j1 = 0;
+        return 0;
+    }
+
+    bool corners = map.cutCorners;
+    unsigned int W = wordsPerRow;
+
+    for(unsigned int step = 1; step <= maxSteps; ++step) {
+        if(target != Map::none && reached(target)) {
+            break;
+        }
+
+        i0 = i0 > 0 ? i0 - 1 : 0;
+        j0 = j0 > 0 ? j0 - 1 : 0;
+        i1 = std::min(i1 + 1, columns - 1);
+        j1 = std::min(j1 + 1, rows - 1);
+
+        unsigned int w0 = i0 >> 6;
+        unsigned int w1 = i1 >> 6;
+        bool grew = false;
+
+        for(unsigned int j = j0; j <= j1; ++j) {
+            const uint64_t* here = &frontier[(size_t) j * W];
+            const uint64_t* above = j > 0 ? here - W : nullptr;
+            const uint64_t* below = j + 1 < rows ? here + W : nullptr;
+            const uint64_t* openHere = &open[(size_t) j * W];
+            const uint64_t* openAbove = j > 0 ? openHere - W : nullptr;
+            const uint64_t* openBelow = j + 1 < rows ? openHere + W : nullptr;
+            uint64_t* out = &next[(size_t) j * W];
+            uint64_t* seen = &visited[(size_t) j * W];
+
+            for(unsigned int w = w0; w <= w1; ++w) {
+                // Bit i of a row is column i, so << 1 moves cells east
+                uint64_t cells = here[w] | east(here, w) | west(here, w, W);
+
+                for(int side = 0; side < 2; ++side) {
+                    const uint64_t* row = side == 0 ? above : below;
+                    const uint64_t* openRow = side == 0 ? openAbove : openBelow;
+
+                    if(row == nullptr) {
+                        continue;
+                    }
+
+                    if(corners) {
+                        cells |= row[w] | east(row, w) | west(row, w, W);
+                    } else {
+                        // A diagonal step passes the cell beside its end in this
+                        // row and the cell beside its source in the other
+                        cells |= row[w] | ((east(row, openHere, w) | west(row, openHere, w, W)) & openRow[w]);
+                    }
+                }
+
+                cells &= openHere[w] & ~seen[w];
+                out[w] = cells;
+
+                if(cells != 0) {
+                    seen[w] |= cells;
+                    visit(j * columns + w * 64, cells, step);
+                    count += bitCount(cells);
+                    grew = true;
+                }
+            }
+        }
+
+        frontier.swap(next);
+
+        if(!grew) {
+            break;
+        }
+    }
+
+    return count;
+}
@@ -0,0 +1,66 @@
+#ifndef __Pathfinding__Flood__
+#define __Pathfinding__Flood__
+
+#include "Map.h"
+#include <cstdint>
+#include <vector>
+
+// Bit-parallel breadth-first flood over the walls. Each row is kept in whole
+// 64-bit words, and one step of the flood works out the next frontier of 64
+// cells at a time from the rows above, below and itself with shifts and
+// masks. The loops are plain word arithmetic, so they vectorize with the
+// compiler's native flags.
+//
+// Distances count moves, not costs. Only the rectangle the flood can have
+// reached is touched, so small floods stay cheap on large maps.
+class Flood {
+public:
+    Flood(const Map& map);
+
+    // Copies the free cells again. Call it after editing walls.
+    void update();
+
+    // Floods from the sources for at most maxSteps moves, following the map's
+    // cutCorners rule. Returns the number of cells reached, sources included.
+    unsigned int run(const std::vector<unsigned int>& sources, unsigned int maxSteps = Map::infinity);
+
+    // Same, also writing each cell's distance in moves to the nearest source,
+    // or Map::infinity if it wasn't reached
+    unsigned int distances(const std::vector<unsigned int>& sources, std::vector<unsigned int>& distance,
+                           unsigned int maxSteps = Map::infinity);
+
+    // Whether there is any path, stopping as soon as the goal is reached
+    bool connected(unsigned int start, unsigned int goal);
+
+    // Whether the last flood reached the cell
+    bool reached(unsigned int node) const;
+
+    const Map& map;
+
+private:
+    template<typename Visitor>
+    unsigned int flood(const std::vector<unsigned int>& sources, unsigned int maxSteps, unsigned int target,
+                       Visitor visit);
+
+    unsigned int rows;
+    unsigned int columns;
+    unsigned int wordsPerRow;
+    std::vector<uint64_t> open;
+    std::vector<uint64_t> visited;
+    std::vector<uint64_t> frontier;
+    std::vector<uint64_t> next;
+
+    // Cells [i0, i1] x [j0, j1] may be set in the buffers
+    unsigned int i0;
+    unsigned int j0;
+    unsigned int i1;
+    unsigned int j1;
+};
+
+inline bool Flood::reached(unsigned int node) const {
+    unsigned int i = node % columns;
+    unsigned int j = node / columns;
+    return (visited[j * wordsPerRow + (i >> 6)] >> (i & 63)) & 1;
+}
+
+#endif /* defined(__Pathfinding__Flood__) */
@@ -0,0 +1,267 @@
+#include "FlowField.h"
+
+void FlowField::reset() {
+    PFAlgorithm::reset();
+
+    if(!map.connected(map.start, map.goal)) {
+        return;
+    }
+
+    Workspace::Cell& goal = search.touch(map.goal);
+    goal.gCost = 0;
+    goal.fCost = 0;
+    open(map.goal, 0);
+}
+
+void FlowField::run(bool toEnd) {
+    while(!openList.empty() && (iterations < iteration || toEnd)) {
+        current = openList.pop();
+        close(current);
+
+        map.forEachNeighbour(current, [this](unsigned int neighbour, unsigned int cost) {
+            unsigned int newCost = search.gCost(current) + cost;
+
+            if(newCost < search.gCost(neighbour)) {
+                Workspace::Cell& cell = search.touch(neighbour);
+                cell.gCost = newCost;
+                cell.fCost = newCost;
+                cell.cameFrom = current;
+                cell.closed = false;
+                open(neighbour, (uint64_t) newCost << 32);
+            }
+        });
+
+        ++iterations;
+    }
+
+    if(toEnd) {
+        iteration = iterations;
+    }
+}
+
+// Follows the field from the start
+std::vector<unsigned int> FlowField::path() {
+    std::vector<unsigned int> cells;
+
+    for(unsigned int node = map.start; node != Map::none; node = search.cameFrom(node)) {
+        cells.push_back(node);
+
+        if(node == map.goal) {
+            return cells;
+        }
+
+        if(cells.size() > map.size()) {
+            break;
+        }
+    }
+
+    return std::vector<unsigned int>();
+}
+
+unsigned int FlowField::heuristic(unsigned int) const {
+    return 0;
+}
+
+void FlowField::wallChanged(unsigned int node) {
+    if(search.size() != map.size() || !search.visited(map.goal) || node == map.goal) {
+        rebuild();
+        return;
+    }
+
+    if(map.wall(node)) {
+        wallAdded(node);
+
+        for(unsigned int cell : cleared) {
+            relax(cell);
+        }
+
+        cleared.clear();
+    } else {
+        wallRemoved(node);
+    }
+
+    run(true);
+    trace.seek(iteration);
+}
+
+// Every new wall in the batch is cleared before anything is refilled, so no
+// cell takes its cost from a step that went through one. Batches over most
+// of the map are cheaper to rebuild.
+void FlowField::wallsChanged(unsigned int i0, unsigned int j0, unsigned int i1, unsigned int j1) {
+    if(search.size() != map.size() || !search.visited(map.goal) || map.wall(map.goal) ||
+       (i1 - i0) * (j1 - j0) > map.size() / 2)
+    {
+        rebuild();
+        return;
+    }
+
+    for(unsigned int j = j0; j < j1; ++j) {
+        for(unsigned int i = i0; i < i1; ++i) {
+            if(map.wall(map.index(i, j))) {
+                wallAdded(map.index(i, j));
+            }
+        }
+    }
+
+    for(unsigned int cell : cleared) {
+        relax(cell);
+    }
+
+    cleared.clear();
+
+    for(unsigned int j = j0; j < j1; ++j) {
+        for(unsigned int i = i0; i < i1; ++i) {
+            unsigned int node = map.index(i, j);
+
+            if(!map.wall(node) && search.gCost(node) == Map::infinity) {
+                wallRemoved(node);
+            }
+        }
+    }
+
+    run(true);
+    trace.seek(iteration);
+}
+
+// The field doesn't depend on the start
+void FlowField::startChanged() {
+    if(search.size() != map.size() || !search.visited(map.goal)) {
+        rebuild();
+    }
+}
+
+void FlowField::goalChanged() {
+    rebuild();
+}
+
+// Costs move every cell's distance, so the field is built again
+void FlowField::costsChanged(unsigned int, unsigned int, unsigned int, unsigned int) {
+    rebuild();
+}
+
+// Built to the end like after an edit. replan() would stop at the iteration
+// being shown.
+void FlowField::rebuild() {
+    reset();
+    run(true);
+    trace.seek(iteration);
+}
+
+// Takes the best step out of a cell from the neighbours that still have a
+// cost and queues the cell if it found one
+void FlowField::relax(unsigned int node) {
+    if(map.wall(node)) {
+        return;
+    }
+
+    unsigned int best = Map::infinity;
+    unsigned int step = Map::none;
+
+    map.forEachNeighbour(node, [&](unsigned int neighbour, unsigned int cost) {
+        if(search.gCost(neighbour) != Map::infinity && search.gCost(neighbour) + cost < best) {
+            best = search.gCost(neighbour) + cost;
+            step = neighbour;
+        }
+    });
+
+    if(step != Map::none && best < search.gCost(node)) {
+        Workspace::Cell& cell = search.touch(node);
+        cell.gCost = best;
+        cell.fCost = best;
+        cell.cameFrom = step;
+        cell.closed = false;
+        open(node, (uint64_t) best << 32);
+    }
+}
+
+// Cells whose step went into the wall or past its corner lose their subtree
+void FlowField::wallAdded(unsigned int node) {
+    int i = map.column(node);
+    int j = map.row(node);
+
+    refill(node);
+
+    for(unsigned int d = 0; d < 8; ++d) {
+        int ni = i + Map::directionI[d];
+        int nj = j + Map::directionJ[d];
+
+        if(ni >= 0 && nj >= 0 && ni < (int) map.columns && nj < (int) map.rows) {
+            unsigned int neighbour = map.index(ni, nj);
+            unsigned int step = search.cameFrom(neighbour);
+            bool linked = false;
+
+            map.forEachNeighbour(neighbour, [&](unsigned int other, unsigned int) {
+                linked = linked || other == step;
+            });
+
+            if(step != Map::none && !linked) {
+                refill(neighbour);
+            }
+        }
+    }
+}
+
+// The cell and the diagonals it unblocks can only shorten distances
+void FlowField::wallRemoved(unsigned int node) {
+    int i = map.column(node);
+    int j = map.row(node);
+
+    relax(node);
+
+    for(unsigned int d = 0; d < 8; ++d) {
+        int ni = i + Map::directionI[d];
+        int nj = j + Map::directionJ[d];
+
+        if(ni >= 0 && nj >= 0 && ni < (int) map.columns && nj < (int) map.rows) {
+            unsigned int neighbour = map.index(ni, nj);
+
+            if(search.gCost(neighbour) != Map::infinity) {
+                open(neighbour, (uint64_t) search.gCost(neighbour) << 32);
+            }
+        }
+    }
+}
+
+// Clears a cell and every cell whose steps lead through it
+void FlowField::refill(unsigned int node) {
+    if(!search.visited(node) || search.gCost(node) == Map::infinity) {
+        return;
+    }
+
+    std::vector<unsigned int> stack(1, node);
+    search.touch(node).gCost = Map::infinity;
+
+    while(!stack.empty()) {
+        unsigned int cell = stack.back();
+        stack.pop_back();
+
+        Workspace::Cell& c = search.touch(cell);
+        c.fCost = Map::infinity;
+        c.cameFrom = Map::none;
+        c.closed = false;
+        cleared.push_back(cell);
+
+        if(openList.contains(cell)) {
+            openList.remove(cell);
+        }
+
+        record(Trace::removed, cell);
+
+        int i = map.column(cell);
+        int j = map.row(cell);
+
+        for(unsigned int d = 0; d < 8; ++d) {
+            int ni = i + Map::directionI[d];
+            int nj = j + Map::directionJ[d];
+
+            if(ni >= 0 && nj >= 0 && ni < (int) map.columns && nj < (int) map.rows) {
+                unsigned int child = map.index(ni, nj);
+
+                if(search.cameFrom(child) == cell && search.gCost(child) != Map::infinity) {
+                    search.touch(child).gCost = Map::infinity;
+                    stack.push_back(child);
+                }
+            }
+        }
+    }
+}
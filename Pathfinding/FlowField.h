@@ -0,0 +1,45 @@
+#ifndef __Pathfinding__FlowField__
+#define __Pathfinding__FlowField__
+
+#include "Search.h"
+#include <vector>
+
+// Dijkstra from the goal over the whole region it is in. Every cell gets its
+// cost to the goal and the next cell to step to, so any number of agents can
+// walk to the same goal at O(1) a step. Moving the start costs nothing. Like
+// the other searches it builds nothing while the start can't reach the goal.
+//
+// A new wall clears the part of the tree that led through it and refills it
+// from the cells around it. A removed wall relaxes outwards from the cell.
+// Anything else rebuilds the field. Either way it is built to the end.
+//
+// gCost holds the cost to the goal and cameFrom the next cell towards it.
+class FlowField : public PFAlgorithm {
+public:
+    FlowField(Map& map) : PFAlgorithm(map) {}
+
+    virtual void reset();
+    virtual void run(bool toEnd);
+    virtual std::vector<unsigned int> path();
+    virtual unsigned int heuristic(unsigned int node) const;
+    virtual void wallChanged(unsigned int node);
+    virtual void wallsChanged(unsigned int i0, unsigned int j0, unsigned int i1, unsigned int j1);
+    virtual void startChanged();
+    virtual void goalChanged();
+    virtual void costsChanged(unsigned int i0, unsigned int j0, unsigned int i1, unsigned int j1);
+
+    // Map::infinity and Map::none for cells that can't reach the goal
+    unsigned int distance(unsigned int node) const { return search.gCost(node); }
+    unsigned int next(unsigned int node) const { return search.cameFrom(node); }
+
+private:
+    void rebuild();
+    void wallAdded(unsigned int node);
+    void wallRemoved(unsigned int node);
+    void relax(unsigned int node);
+    void refill(unsigned int node);
+
+    std::vector<unsigned int> cleared;
+};
+
+#endif /* defined(__Pathfinding__FlowField__) */
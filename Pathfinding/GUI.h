@@ -171,9 +171,30 @@ public:
         handle = sf::CircleShape(5);
         handle.setFillColor(sf::Color::White);
         handle.setPosition(2, 2);
+        clickableArea = sf::IntRect(0, 0, width, 14);
+        setValue(maxValue / 2);
+    }
+    
+    bool contains(sf::Vector2i point) {
+        sf::Vector2f local = sf::Vector2f(point.x, point.y) - getPosition();
+        return clickableArea.contains((int) local.x, (int) local.y);
+    }
+    
+    // Moves the handle under a point along the line
+    void setFromPoint(sf::Vector2i point) {
+        float x = (point.x - getPosition().x - 7) / (width - 14);
+        setValue((unsigned int) (std::max(0.f, std::min(x, 1.f)) * maxValue + 0.5f));
+    }
+    
+    void setValue(unsigned int value) {
+        this->value = value;
+        float x = (float) value / maxValue * (width - 14);
+        handleBorder.setPosition(x, 0);
+        handle.setPosition(x + 2, 2);
     }
     
     unsigned int maxValue;
+    unsigned int value;
     
     unsigned int width;
     sf::IntRect clickableArea;
@@ -0,0 +1,459 @@
+#include "HPAStar.h"
+#include "Heuristic.h"
+#include <algorithm>
+
+HPAStar::HPAStar(Map& map, unsigned int clusterSize)
+: PFAlgorithm(map),
+  clusterSize(clusterSize),
+  clustersI(0),
+  clustersJ(0),
+  mapRows(0),
+  mapColumns(0),
+  costVersion(0),
+  directCost(Map::infinity)
+{}
+
+void HPAStar::reset() {
+    PFAlgorithm::reset();
+    refined.clear();
+
+    unsigned int columns = (map.columns + clusterSize - 1) / clusterSize;
+    unsigned int rows = (map.rows + clusterSize - 1) / clusterSize;
+
+    if(columns != clustersI || rows != clustersJ || map.columns != mapColumns || map.rows != mapRows ||
+       map.costVersion != costVersion || clusters.empty())
+    {
+        clustersI = columns;
+        clustersJ = rows;
+        mapColumns = map.columns;
+        mapRows = map.rows;
+        costVersion = map.costVersion;
+        clusters.assign(clustersI * clustersJ, Cluster());
+        walls.assign(map.walls.begin(), map.walls.end());
+
+        localOpen.resize(clusterSize * clusterSize);
+        localCost.assign(clusterSize * clusterSize, Map::infinity);
+        localParent.assign(clusterSize * clusterSize, Map::none);
+
+        for(unsigned int c = 0; c < clusters.size(); ++c) {
+            buildBorder(c, true);
+            buildBorder(c, false);
+            clusters[c].dirty = true;
+        }
+    } else if(!std::equal(walls.begin(), walls.end(), map.walls.begin())) {
+        // Edited while another algorithm was active
+        for(unsigned int word = 0; word < walls.size(); ++word) {
+            uint64_t changed = walls[word] ^ map.walls[word];
+
+            for(unsigned int bit = 0; changed != 0; ++bit, changed >>= 1) {
+                if(changed & 1) {
+                    updateBorders(word * 64 + bit);
+                }
+            }
+        }
+
+        walls.assign(map.walls.begin(), map.walls.end());
+    }
+
+    for(unsigned int c = 0; c < clusters.size(); ++c) {
+        if(clusters[c].dirty) {
+            buildCluster(c);
+        }
+    }
+
+    connect();
+}
+
+// Links the start and the goal to the entrances of their clusters
+void HPAStar::connect() {
+    if(!map.connected(map.start, map.goal)) {
+        return;
+    }
+
+    unsigned int startCluster = clusterOf(map.start);
+    unsigned int goalCluster = clusterOf(map.goal);
+    const Cluster& fromStart = clusters[startCluster];
+    const Cluster& toGoal = clusters[goalCluster];
+
+    localSearch(startCluster, map.start);
+    startCost.resize(fromStart.entrances.size());
+
+    for(unsigned int k = 0; k < fromStart.entrances.size(); ++k) {
+        startCost[k] = localCostTo(startCluster, fromStart.entrances[k]);
+    }
+
+    localSearch(goalCluster, map.goal);
+    goalCost.resize(toGoal.entrances.size());
+
+    for(unsigned int k = 0; k < toGoal.entrances.size(); ++k) {
+        goalCost[k] = localCostTo(goalCluster, toGoal.entrances[k]);
+    }
+
+    directCost = startCluster == goalCluster ? localCostTo(goalCluster, map.start) : Map::infinity;
+
+    Workspace::Cell& start = search.touch(map.start);
+    start.gCost = 0;
+    start.fCost = estimate<Octile>(map, map.start, map.goal);
+    open(map.start, (uint64_t) start.fCost << 32);
+}
+
+void HPAStar::run(bool toEnd) {
+    unsigned int goalCluster = clusterOf(map.goal);
+    const Cluster& fromStart = clusters[clusterOf(map.start)];
+
+    while(!openList.empty() && (iterations < iteration || toEnd)) {
+        current = openList.top();
+
+        if(current == map.goal) {
+            break;
+        }
+
+        openList.pop();
+        close(current);
+
+        unsigned int c = clusterOf(current);
+        const Cluster& cluster = clusters[c];
+
+        if(current == map.start) {
+            for(unsigned int k = 0; k < fromStart.entrances.size(); ++k) {
+                if(startCost[k] != Map::infinity) {
+                    relax(current, fromStart.entrances[k], startCost[k]);
+                }
+            }
+
+            if(directCost != Map::infinity) {
+                relax(current, map.goal, directCost);
+            }
+        }
+
+        unsigned int k = entranceIndex(cluster, current);
+
+        if(k != Map::none) {
+            unsigned int node = current;
+            unsigned int n = (unsigned int) cluster.entrances.size();
+
+            for(unsigned int m = 0; m < n; ++m) {
+                if(m != k && cluster.distances[k * n + m] != Map::infinity) {
+                    relax(current, cluster.entrances[m], cluster.distances[k * n + m]);
+                }
+            }
+
+            if(c == goalCluster && goalCost[k] != Map::infinity) {
+                relax(current, map.goal, goalCost[k]);
+            }
+
+            // Transitions into the neighbouring clusters
+            forEachTransition(c, [&](const Transition& t) {
+                if(t.inside == node) relax(node, t.outside, t.cost);
+                if(t.outside == node) relax(node, t.inside, t.cost);
+            });
+        }
+
+        ++iterations;
+    }
+
+    if(current == map.goal && refined.empty()) {
+        std::vector<unsigned int> abstract = PFAlgorithm::path();
+
+        for(unsigned int a = 0; a < abstract.size(); ++a) {
+            if(a == 0 || clusterOf(abstract[a - 1]) != clusterOf(abstract[a])) {
+                refined.push_back(abstract[a]);
+                continue;
+            }
+
+            unsigned int c = clusterOf(abstract[a]);
+            std::vector<unsigned int> segment;
+            localSearch(c, abstract[a - 1]);
+
+            for(unsigned int node = abstract[a]; node != abstract[a - 1]; ) {
+                segment.push_back(node);
+                node = localParent[(map.row(node) - (c / clustersI) * clusterSize) * clusterSize +
+                                   map.column(node) - (c % clustersI) * clusterSize];
+            }
+
+            refined.insert(refined.end(), segment.rbegin(), segment.rend());
+        }
+    }
+
+    if(toEnd) {
+        iteration = iterations;
+    }
+}
+
+std::vector<unsigned int> HPAStar::path() {
+    return refined;
+}
+
+void HPAStar::wallChanged(unsigned int node) {
+    if(clusters.empty()) {
+        replan();
+        return;
+    }
+
+    updateBorders(node);
+    walls[node >> 6] = map.walls[node >> 6];
+    replan();
+}
+
+// Costs change the transitions on the borders the region touches and the
+// distances inside the clusters it overlaps
+void HPAStar::costsChanged(unsigned int i0, unsigned int j0, unsigned int i1, unsigned int j1) {
+    if(clusters.empty() || map.columns != mapColumns || map.rows != mapRows) {
+        replan();
+        return;
+    }
+
+    unsigned int ci0 = i0 / clusterSize;
+    unsigned int cj0 = j0 / clusterSize;
+    unsigned int ci1 = (i1 - 1) / clusterSize;
+    unsigned int cj1 = (j1 - 1) / clusterSize;
+
+    for(unsigned int cj = cj0 > 0 ? cj0 - 1 : 0; cj <= cj1; ++cj) {
+        for(unsigned int ci = ci0 > 0 ? ci0 - 1 : 0; ci <= ci1; ++ci) {
+            unsigned int c = cj * clustersI + ci;
+            buildBorder(c, true);
+            buildBorder(c, false);
+
+            if(ci >= ci0 && cj >= cj0) {
+                clusters[c].dirty = true;
+            }
+        }
+    }
+
+    costVersion = map.costVersion;
+    replan();
+}
+
+unsigned int HPAStar::clusterOf(unsigned int node) const {
+    return (map.row(node) / clusterSize) * clustersI + map.column(node) / clusterSize;
+}
+
+unsigned int HPAStar::entranceIndex(const Cluster& cluster, unsigned int node) const {
+    for(unsigned int k = 0; k < cluster.entrances.size(); ++k) {
+        if(cluster.entrances[k] == node) {
+            return k;
+        }
+    }
+
+    return Map::none;
+}
+
+// Rebuilds the transitions on the east or south border of a cluster.
+// Free runs shorter than 6 cells get one transition in the middle, longer
+// ones get one at each end. Diagonal squeezes are only added where no
+// straight transition is next to them, at the cluster corners too.
+// Clusters owning an old or new endpoint are marked dirty if anything moved.
+void HPAStar::buildBorder(unsigned int cluster, bool east) {
+    unsigned int ci = cluster % clustersI;
+    unsigned int cj = cluster / clustersI;
+    std::vector<Transition> transitions;
+
+    if((east && ci + 1 < clustersI) || (!east && cj + 1 < clustersJ)) {
+        unsigned int first = east ? map.index((ci + 1) * clusterSize - 1, cj * clusterSize)
+                                  : map.index(ci * clusterSize, (cj + 1) * clusterSize - 1);
+        unsigned int step = east ? map.columns : 1;
+        unsigned int across = east ? 1 : map.columns;
+        unsigned int length = east ? std::min(clusterSize, map.rows - cj * clusterSize)
+                                   : std::min(clusterSize, map.columns - ci * clusterSize);
+        bool more = east ? cj * clusterSize + length < map.rows
+                         : ci * clusterSize + length < map.columns;
+        unsigned int runStart = 0;
+        unsigned int runLength = 0;
+
+        for(unsigned int k = 0; k <= length; ++k) {
+            unsigned int inside = first + k * step;
+            bool free = k < length && !map.wall(inside) && !map.wall(inside + across);
+
+            if(free) {
+                if(runLength == 0) {
+                    runStart = k;
+                }
+
+                ++runLength;
+                continue;
+            }
+
+            if(runLength > 0) {
+                unsigned int runFirst = first + runStart * step;
+
+                if(runLength < 6) {
+                    unsigned int middle = runFirst + (runLength / 2) * step;
+                    transitions.push_back(Transition{middle, middle + across, map.movCost(middle, middle + across)});
+                } else {
+                    unsigned int last = runFirst + (runLength - 1) * step;
+                    transitions.push_back(Transition{runFirst, runFirst + across, map.movCost(runFirst, runFirst + across)});
+                    transitions.push_back(Transition{last, last + across, map.movCost(last, last + across)});
+                }
+
+                runLength = 0;
+            }
+        }
+
+        for(unsigned int k = 0; map.cutCorners && k < length; ++k) {
+            if(k + 1 == length && !more) {
+                break;
+            }
+
+            unsigned int inside = first + k * step;
+            unsigned int next = inside + step;
+
+            if(!map.wall(inside) && !map.wall(next + across) &&
+               map.wall(inside + across) && map.wall(next)) {
+                transitions.push_back(Transition{inside, next + across, map.movCost(inside, next + across)});
+            }
+
+            if(!map.wall(next) && !map.wall(inside + across) &&
+               map.wall(inside) && map.wall(next + across)) {
+                transitions.push_back(Transition{next, inside + across, map.movCost(next, inside + across)});
+            }
+        }
+    }
+
+    std::vector<Transition>& border = east ? clusters[cluster].east : clusters[cluster].south;
+    bool changed = transitions.size() != border.size();
+
+    for(unsigned int k = 0; !changed && k < transitions.size(); ++k) {
+        changed = transitions[k].inside != border[k].inside || transitions[k].outside != border[k].outside ||
+                  transitions[k].cost != border[k].cost;
+    }
+
+    if(changed) {
+        for(const Transition& t : border) {
+            clusters[clusterOf(t.inside)].dirty = true;
+            clusters[clusterOf(t.outside)].dirty = true;
+        }
+
+        for(const Transition& t : transitions) {
+            clusters[clusterOf(t.inside)].dirty = true;
+            clusters[clusterOf(t.outside)].dirty = true;
+        }
+
+        border.swap(transitions);
+    }
+}
+
+// Calls visit(transition) for every transition that may have an end in the
+// cluster. Those all sit on the borders of the cluster or of the clusters to
+// its left, above it and above-left of it.
+template<typename Visitor>
+void HPAStar::forEachTransition(unsigned int cluster, Visitor visit) const {
+    int ci = cluster % clustersI;
+    int cj = cluster / clustersI;
+
+    for(int nj = std::max(cj - 1, 0); nj <= cj && nj < (int) clustersJ; ++nj) {
+        for(int ni = std::max(ci - 1, 0); ni <= ci && ni < (int) clustersI; ++ni) {
+            const Cluster& neighbour = clusters[nj * clustersI + ni];
+
+            for(const Transition& t : neighbour.east) visit(t);
+            for(const Transition& t : neighbour.south) visit(t);
+        }
+    }
+}
+
+// Collects the cluster's entrances and the distances between every pair
+void HPAStar::buildCluster(unsigned int cluster) {
+    Cluster& c = clusters[cluster];
+    c.entrances.clear();
+
+    forEachTransition(cluster, [&](const Transition& t) {
+        if(clusterOf(t.inside) == cluster) c.entrances.push_back(t.inside);
+        if(clusterOf(t.outside) == cluster) c.entrances.push_back(t.outside);
+    });
+
+    std::sort(c.entrances.begin(), c.entrances.end());
+    c.entrances.erase(std::unique(c.entrances.begin(), c.entrances.end()), c.entrances.end());
+
+    unsigned int n = (unsigned int) c.entrances.size();
+    c.distances.assign(n * n, Map::infinity);
+
+    for(unsigned int k = 0; k < n; ++k) {
+        localSearch(cluster, c.entrances[k]);
+
+        for(unsigned int m = 0; m < n; ++m) {
+            c.distances[k * n + m] = localCostTo(cluster, c.entrances[m]);
+        }
+    }
+
+    c.dirty = false;
+}
+
+// An edited cell can only move transitions on the borders of its own cluster
+// and of the clusters left of and above it
+void HPAStar::updateBorders(unsigned int node) {
+    unsigned int cluster = clusterOf(node);
+    unsigned int ci = cluster % clustersI;
+    unsigned int cj = cluster / clustersI;
+
+    clusters[cluster].dirty = true;
+
+    for(unsigned int nj = cj > 0 ? cj - 1 : 0; nj <= cj; ++nj) {
+        for(unsigned int ni = ci > 0 ? ci - 1 : 0; ni <= ci; ++ni) {
+            buildBorder(nj * clustersI + ni, true);
+            buildBorder(nj * clustersI + ni, false);
+        }
+    }
+}
+
+// Dijkstra from a cell, restricted to the cells of its cluster
+void HPAStar::localSearch(unsigned int cluster, unsigned int from) {
+    unsigned int i0 = (cluster % clustersI) * clusterSize;
+    unsigned int j0 = (cluster / clustersI) * clusterSize;
+    unsigned int i1 = std::min(i0 + clusterSize, map.columns);
+    unsigned int j1 = std::min(j0 + clusterSize, map.rows);
+
+    std::fill(localCost.begin(), localCost.end(), Map::infinity);
+    std::fill(localParent.begin(), localParent.end(), Map::none);
+    localOpen.clear();
+
+    if(map.wall(from)) {
+        return;
+    }
+
+    unsigned int local = (map.row(from) - j0) * clusterSize + map.column(from) - i0;
+    localCost[local] = 0;
+    localOpen.push(local, 0);
+
+    while(!localOpen.empty()) {
+        unsigned int node = localOpen.pop();
+        unsigned int cell = map.index(i0 + node % clusterSize, j0 + node / clusterSize);
+
+        map.forEachNeighbour(cell, [&](unsigned int neighbour, unsigned int cost) {
+            unsigned int ni = map.column(neighbour);
+            unsigned int nj = map.row(neighbour);
+
+            if(ni < i0 || nj < j0 || ni >= i1 || nj >= j1) {
+                return;
+            }
+
+            unsigned int next = (nj - j0) * clusterSize + ni - i0;
+
+            if(localCost[node] + cost < localCost[next]) {
+                localCost[next] = localCost[node] + cost;
+                localParent[next] = cell;
+                localOpen.push(next, localCost[next]);
+            }
+        });
+    }
+}
+
+unsigned int HPAStar::localCostTo(unsigned int cluster, unsigned int node) const {
+    unsigned int i0 = (cluster % clustersI) * clusterSize;
+    unsigned int j0 = (cluster / clustersI) * clusterSize;
+    return localCost[(map.row(node) - j0) * clusterSize + map.column(node) - i0];
+}
+
+void HPAStar::relax(unsigned int node, unsigned int neighbour, unsigned int cost) {
+    if(search.closed(neighbour)) {
+        return;
+    }
+
+    unsigned int newCost = search.gCost(node) + cost;
+
+    if(newCost < search.gCost(neighbour)) {
+        Workspace::Cell& cell = search.touch(neighbour);
+        cell.gCost = newCost;
+        cell.fCost = newCost + estimate<Octile>(map, neighbour, map.goal);
+        cell.cameFrom = node;
+        open(neighbour, (uint64_t) cell.fCost << 32);
+    }
+}
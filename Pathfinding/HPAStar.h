@@ -0,0 +1,73 @@
+#ifndef __Pathfinding__HPAStar__
+#define __Pathfinding__HPAStar__
+
+#include "Search.h"
+#include <vector>
+
+// Hierarchical A*. The map is cut into square clusters; entrances are placed
+// on the free runs along shared cluster borders and the distances between a
+// cluster's entrances are cached. Queries search the graph of entrances and
+// refine the result with small searches inside single clusters.
+//
+// A wall edit only rebuilds the borders it touches and the clusters whose
+// entrances changed. cameFrom links abstract nodes; path() returns cells.
+class HPAStar : public PFAlgorithm {
+public:
+    HPAStar(Map& map, unsigned int clusterSize = 16);
+
+    virtual void reset();
+    virtual void run(bool toEnd);
+    virtual std::vector<unsigned int> path();
+    virtual void wallChanged(unsigned int node);
+    virtual void costsChanged(unsigned int i0, unsigned int j0, unsigned int i1, unsigned int j1);
+
+    unsigned int clusterSize;
+
+private:
+    struct Transition {
+        unsigned int inside;
+        unsigned int outside;
+        unsigned int cost;
+    };
+
+    struct Cluster {
+        std::vector<Transition> east;
+        std::vector<Transition> south;
+        std::vector<unsigned int> entrances;
+        std::vector<unsigned int> distances;
+        bool dirty;
+    };
+
+    unsigned int clusterOf(unsigned int node) const;
+    unsigned int entranceIndex(const Cluster& cluster, unsigned int node) const;
+    void buildBorder(unsigned int cluster, bool east);
+    template<typename Visitor>
+    void forEachTransition(unsigned int cluster, Visitor visit) const;
+    void buildCluster(unsigned int cluster);
+    void connect();
+    void updateBorders(unsigned int node);
+    void localSearch(unsigned int cluster, unsigned int from);
+    unsigned int localCostTo(unsigned int cluster, unsigned int node) const;
+    void relax(unsigned int node, unsigned int neighbour, unsigned int cost);
+
+    std::vector<Cluster> clusters;
+    unsigned int clustersI;
+    unsigned int clustersJ;
+
+    // The map the clusters were cut from
+    unsigned int mapRows;
+    unsigned int mapColumns;
+    unsigned int costVersion;
+    std::vector<uint64_t> walls;
+
+    OpenList localOpen;
+    std::vector<unsigned int> localCost;
+    std::vector<unsigned int> localParent;
+
+    std::vector<unsigned int> startCost;
+    std::vector<unsigned int> goalCost;
+    unsigned int directCost;
+    std::vector<unsigned int> refined;
+};
+
+#endif /* defined(__Pathfinding__HPAStar__) */
@@ -0,0 +1,49 @@
+#ifndef __Pathfinding__Heuristic__
+#define __Pathfinding__Heuristic__
+
+#include "Map.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+// Estimates of the cost between two cells that are di columns and dj rows
+// apart, in the map's units of 10 per straight move and 14 per diagonal one.
+// They are template policies so searches call them inline.
+
+// Exact on an open 8-connected grid
+struct Octile {
+    static unsigned int distance(unsigned int di, unsigned int dj) {
+        return 14 * std::min(di, dj) + 10 * (std::max(di, dj) - std::min(di, dj));
+    }
+};
+
+// Counts every move as a straight one
+struct Chebyshev {
+    static unsigned int distance(unsigned int di, unsigned int dj) {
+        return 10 * std::max(di, dj);
+    }
+};
+
+// Scaled by 14 / sqrt(2) rather than 10 so a diagonal run isn't overestimated
+struct Euclidean {
+    static unsigned int distance(unsigned int di, unsigned int dj) {
+        return (unsigned int) (std::sqrt((double) (di * di + dj * dj)) * 9.8994949);
+    }
+};
+
+// Exact on a 4-connected grid. Diagonal moves are overestimated here, so
+// searches using it give up optimality for fewer expansions.
+struct Manhattan {
+    static unsigned int distance(unsigned int di, unsigned int dj) {
+        return 10 * (di + dj);
+    }
+};
+
+template<typename Heuristic>
+inline unsigned int estimate(const Map& map, unsigned int n1, unsigned int n2) {
+    unsigned int di = std::abs((int) map.column(n1) - (int) map.column(n2));
+    unsigned int dj = std::abs((int) map.row(n1) - (int) map.row(n2));
+    return Heuristic::distance(di, dj);
+}
+
+#endif /* defined(__Pathfinding__Heuristic__) */
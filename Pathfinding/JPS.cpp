@@ -0,0 +1,271 @@
+#include "JPS.h"
+#include "Heuristic.h"
+#include <algorithm>
+#include <cstdlib>
+
+static int sign(int value) {
+    return (value > 0) - (value < 0);
+}
+
+// Octile distance, which is the exact cost between a cell and a jump point
+static unsigned int jumpCost(int di, int dj) {
+    return Octile::distance(std::abs(di), std::abs(dj));
+}
+
+void JPS::reset() {
+    PFAlgorithm::reset();
+
+    if(!map.connected(map.start, map.goal)) {
+        return;
+    }
+
+    unsigned int h = estimate<Octile>(map, map.start, map.goal);
+    Workspace::Cell& start = search.touch(map.start);
+    start.gCost = 0;
+    start.fCost = h;
+    open(map.start, ((uint64_t) h << 32) | h);
+}
+
+void JPS::run(bool toEnd) {
+    int di[8];
+    int dj[8];
+
+    while(!openList.empty() && (iterations < iteration || toEnd)) {
+        current = openList.top();
+
+        if(current == map.goal) {
+            break;
+        }
+
+        openList.pop();
+        close(current);
+
+        if(map.weighted()) {
+            map.forEachNeighbour(current, [this](unsigned int neighbour, unsigned int cost) {
+                relax(neighbour, cost);
+            });
+
+            ++iterations;
+            continue;
+        }
+
+        int i = map.column(current);
+        int j = map.row(current);
+        unsigned int count = directions(current, di, dj);
+
+        for(unsigned int d = 0; d < count; ++d) {
+            unsigned int jumpPoint = jump(i, j, di[d], dj[d]);
+
+            if(jumpPoint != Map::none) {
+                relax(jumpPoint, jumpCost(map.column(jumpPoint) - i, map.row(jumpPoint) - j));
+            }
+        }
+
+        ++iterations;
+    }
+
+    if(toEnd) {
+        iteration = iterations;
+    }
+}
+
+void JPS::relax(unsigned int node, unsigned int cost) {
+    if(search.closed(node)) {
+        return;
+    }
+
+    unsigned int newCost = search.gCost(current) + cost;
+
+    if(newCost < search.gCost(node)) {
+        unsigned int h = estimate<Octile>(map, node, map.goal);
+        Workspace::Cell& cell = search.touch(node);
+        cell.gCost = newCost;
+        cell.fCost = newCost + h;
+        cell.cameFrom = current;
+        open(node, ((uint64_t) cell.fCost << 32) | h);
+    }
+}
+
+// Expands the straight and diagonal runs between jump points
+std::vector<unsigned int> JPS::path() {
+    std::vector<unsigned int> jumpPoints = PFAlgorithm::path();
+    std::vector<unsigned int> cells;
+
+    for(unsigned int k = 0; k < jumpPoints.size(); ++k) {
+        if(k == 0) {
+            cells.push_back(jumpPoints[k]);
+            continue;
+        }
+
+        int i = map.column(jumpPoints[k - 1]);
+        int j = map.row(jumpPoints[k - 1]);
+        int ti = map.column(jumpPoints[k]);
+        int tj = map.row(jumpPoints[k]);
+
+        while(i != ti || j != tj) {
+            i += sign(ti - i);
+            j += sign(tj - j);
+            cells.push_back(map.index(i, j));
+        }
+    }
+
+    return cells;
+}
+
+bool JPS::walkable(int i, int j) const {
+    return i >= 0 && j >= 0 && i < (int) map.columns && j < (int) map.rows && !map.wall(j * map.columns + i);
+}
+
+// Moves from (i, j) along a row or column until it hits a wall, the goal or a
+// cell with a forced neighbour
+unsigned int JPS::jumpStraight(int i, int j, int di, int dj) const {
+    while(true) {
+        i += di;
+        j += dj;
+
+        if(!walkable(i, j)) {
+            return Map::none;
+        }
+
+        unsigned int node = map.index(i, j);
+
+        if(node == map.goal) {
+            return node;
+        }
+
+        if(map.cutCorners) {
+            if(di != 0) {
+                if((walkable(i + di, j + 1) && !walkable(i, j + 1)) ||
+                   (walkable(i + di, j - 1) && !walkable(i, j - 1))) {
+                    return node;
+                }
+            } else {
+                if((walkable(i + 1, j + dj) && !walkable(i + 1, j)) ||
+                   (walkable(i - 1, j + dj) && !walkable(i - 1, j))) {
+                    return node;
+                }
+            }
+        } else {
+            if(di != 0) {
+                if((walkable(i, j - 1) && !walkable(i - di, j - 1)) ||
+                   (walkable(i, j + 1) && !walkable(i - di, j + 1))) {
+                    return node;
+                }
+            } else {
+                if((walkable(i - 1, j) && !walkable(i - 1, j - dj)) ||
+                   (walkable(i + 1, j) && !walkable(i + 1, j - dj))) {
+                    return node;
+                }
+            }
+        }
+    }
+}
+
+unsigned int JPS::jump(int i, int j, int di, int dj) const {
+    if(di == 0 || dj == 0) {
+        return jumpStraight(i, j, di, dj);
+    }
+
+    while(true) {
+        if(!map.cutCorners && (!walkable(i + di, j) || !walkable(i, j + dj))) {
+            return Map::none;
+        }
+
+        i += di;
+        j += dj;
+
+        if(!walkable(i, j)) {
+            return Map::none;
+        }
+
+        unsigned int node = map.index(i, j);
+
+        if(node == map.goal) {
+            return node;
+        }
+
+        if(map.cutCorners &&
+           ((walkable(i - di, j + dj) && !walkable(i - di, j)) ||
+            (walkable(i + di, j - dj) && !walkable(i, j - dj)))) {
+            return node;
+        }
+
+        if(jumpStraight(i, j, di, 0) != Map::none || jumpStraight(i, j, 0, dj) != Map::none) {
+            return node;
+        }
+    }
+}
+
+// Fills the directions worth jumping in from a node, pruned by the direction
+// it was reached from. Returns how many there are.
+unsigned int JPS::directions(unsigned int node, int* di, int* dj) const {
+    unsigned int count = 0;
+    unsigned int parent = search.cameFrom(node);
+
+    if(parent == Map::none) {
+        for(unsigned int d = 0; d < 8; ++d) {
+            di[count] = Map::directionI[d];
+            dj[count] = Map::directionJ[d];
+            ++count;
+        }
+
+        return count;
+    }
+
+    int i = map.column(node);
+    int j = map.row(node);
+    int dx = sign(i - (int) map.column(parent));
+    int dy = sign(j - (int) map.row(parent));
+
+    if(dx != 0 && dy != 0) {
+        di[count] = 0; dj[count] = dy; ++count;
+        di[count] = dx; dj[count] = 0; ++count;
+        di[count] = dx; dj[count] = dy; ++count;
+
+        if(map.cutCorners) {
+            if(!walkable(i - dx, j)) {
+                di[count] = -dx; dj[count] = dy; ++count;
+            }
+
+            if(!walkable(i, j - dy)) {
+                di[count] = dx; dj[count] = -dy; ++count;
+            }
+        }
+    } else if(dx != 0) {
+        di[count] = dx; dj[count] = 0; ++count;
+
+        if(map.cutCorners) {
+            if(!walkable(i, j + 1)) {
+                di[count] = dx; dj[count] = 1; ++count;
+            }
+
+            if(!walkable(i, j - 1)) {
+                di[count] = dx; dj[count] = -1; ++count;
+            }
+        } else {
+            di[count] = 0; dj[count] = 1; ++count;
+            di[count] = 0; dj[count] = -1; ++count;
+            di[count] = dx; dj[count] = 1; ++count;
+            di[count] = dx; dj[count] = -1; ++count;
+        }
+    } else {
+        di[count] = 0; dj[count] = dy; ++count;
+
+        if(map.cutCorners) {
+            if(!walkable(i + 1, j)) {
+                di[count] = 1; dj[count] = dy; ++count;
+            }
+
+            if(!walkable(i - 1, j)) {
+                di[count] = -1; dj[count] = dy; ++count;
+            }
+        } else {
+            di[count] = 1; dj[count] = 0; ++count;
+            di[count] = -1; dj[count] = 0; ++count;
+            di[count] = 1; dj[count] = dy; ++count;
+            di[count] = -1; dj[count] = dy; ++count;
+        }
+    }
+
+    return count;
+}
@@ -0,0 +1,30 @@
+#ifndef __Pathfinding__JPS__
+#define __Pathfinding__JPS__
+
+#include "Search.h"
+#include <vector>
+
+// Jump Point Search: A* over the uniform-cost 8-connected grid that only
+// queues the jump points where a symmetric run of moves has to turn.
+// Follows the map's cutCorners rule, so it finds the same path costs as AStar.
+//
+// cameFrom links jump points; path() fills in the cells between them. On a
+// map with cell costs no run is symmetric, so it expands every neighbour like
+// plain A*.
+class JPS : public PFAlgorithm {
+public:
+    JPS(Map& map) : PFAlgorithm(map) {}
+
+    virtual void reset();
+    virtual void run(bool toEnd);
+    virtual std::vector<unsigned int> path();
+
+private:
+    bool walkable(int i, int j) const;
+    unsigned int jump(int i, int j, int di, int dj) const;
+    unsigned int jumpStraight(int i, int j, int di, int dj) const;
+    unsigned int directions(unsigned int node, int* di, int* dj) const;
+    void relax(unsigned int node, unsigned int cost);
+};
+
+#endif /* defined(__Pathfinding__JPS__) */
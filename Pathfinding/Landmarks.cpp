@@ -0,0 +1,243 @@
+#include "Landmarks.h"
+#include "OpenList.h"
+#include <fstream>
+
+const uint16_t Landmarks::unreachable;
+
+static const char magic[4] = { 'P', 'F', 'L', 'M' };
+
+void Landmarks::build(const Map& map) {
+    rows = map.rows;
+    columns = map.columns;
+    cutCorners = map.cutCorners;
+    walls.assign(map.walls.begin(), map.walls.end());
+    costs = map.costs;
+    checkedCosts = map.costVersion;
+    nodes.clear();
+    units.clear();
+
+    unsigned int seed = largestRegion(map);
+    std::vector<unsigned int> distance;
+    std::vector<unsigned int> nearest;
+    std::vector<std::vector<uint16_t> > tables;
+
+    // The first landmark is the cell farthest from the seed, every next one
+    // the cell farthest from all landmarks so far. They all go in the largest
+    // region; elsewhere the bound is 0.
+    if(seed != Map::none) {
+        dijkstra(map, seed, nearest);
+    }
+
+    while(seed != Map::none && tables.size() < count) {
+        unsigned int next = seed;
+
+        for(unsigned int node = 0; node < map.size(); ++node) {
+            if(nearest[node] != Map::infinity && nearest[node] > nearest[next]) {
+                next = node;
+            }
+        }
+
+        if(!tables.empty() && nearest[next] == 0) {
+            break;
+        }
+
+        dijkstra(map, next, distance);
+
+        unsigned int longest = 0;
+
+        for(unsigned int d : distance) {
+            if(d != Map::infinity) {
+                longest = std::max(longest, d);
+            }
+        }
+
+        unsigned int unit = longest / unreachable + 1;
+        tables.push_back(std::vector<uint16_t>(map.size(), unreachable));
+
+        for(unsigned int node = 0; node < map.size(); ++node) {
+            if(distance[node] != Map::infinity) {
+                tables.back()[node] = (uint16_t) (distance[node] / unit);
+            }
+
+            nearest[node] = tables.size() == 1 ? distance[node] : std::min(nearest[node], distance[node]);
+        }
+
+        nodes.push_back(next);
+        units.push_back(unit);
+    }
+
+    unsigned int landmarks = (unsigned int) nodes.size();
+    distances.assign((size_t) map.size() * landmarks, unreachable);
+
+    for(unsigned int k = 0; k < landmarks; ++k) {
+        for(unsigned int node = 0; node < map.size(); ++node) {
+            distances[(size_t) node * landmarks + k] = tables[k][node];
+        }
+    }
+}
+
+bool Landmarks::stale(const Map& map) const {
+    if(rows != map.rows || columns != map.columns || (map.cutCorners && !cutCorners)) {
+        return true;
+    }
+
+    for(unsigned int word = 0; word < walls.size(); ++word) {
+        if(walls[word] & ~map.walls[word]) {
+            return true;
+        }
+    }
+
+    if(map.costVersion != checkedCosts) {
+        for(unsigned int node = 0; node < map.size(); ++node) {
+            if(map.cost(node) < (costs.empty() ? 1u : costs[node])) {
+                return true;
+            }
+        }
+
+        checkedCosts = map.costVersion;
+    }
+
+    return false;
+}
+
+bool Landmarks::save(const std::string& path) const {
+    std::ofstream file(path.c_str(), std::ios::binary);
+    return write(file);
+}
+
+bool Landmarks::load(const std::string& path, const Map& map) {
+    std::ifstream file(path.c_str(), std::ios::binary);
+    return read(file, map);
+}
+
+bool Landmarks::write(std::ostream& file) const {
+    unsigned int landmarks = (unsigned int) nodes.size();
+    unsigned char corners = cutCorners;
+    unsigned char weighted = !costs.empty();
+
+    file.write(magic, sizeof(magic));
+    file.write((const char*) &rows, sizeof(rows));
+    file.write((const char*) &columns, sizeof(columns));
+    file.write((const char*) &corners, sizeof(corners));
+    file.write((const char*) &landmarks, sizeof(landmarks));
+    file.write((const char*) walls.data(), walls.size() * sizeof(uint64_t));
+    file.write((const char*) &weighted, sizeof(weighted));
+    file.write((const char*) costs.data(), costs.size());
+    file.write((const char*) nodes.data(), landmarks * sizeof(unsigned int));
+    file.write((const char*) units.data(), landmarks * sizeof(unsigned int));
+    file.write((const char*) distances.data(), distances.size() * sizeof(uint16_t));
+
+    return file.good();
+}
+
+bool Landmarks::read(std::istream& file, const Map& map) {
+    char header[4];
+    unsigned int fileRows = 0;
+    unsigned int fileColumns = 0;
+    unsigned char corners = 0;
+    unsigned char weighted = 0;
+    unsigned int landmarks = 0;
+
+    file.read(header, sizeof(header));
+    file.read((char*) &fileRows, sizeof(fileRows));
+    file.read((char*) &fileColumns, sizeof(fileColumns));
+    file.read((char*) &corners, sizeof(corners));
+    file.read((char*) &landmarks, sizeof(landmarks));
+
+    if(!file || !std::equal(magic, magic + 4, header) ||
+       fileRows != map.rows || fileColumns != map.columns || landmarks == 0)
+    {
+        return false;
+    }
+
+    std::vector<uint64_t> fileWalls(map.walls.size());
+    std::vector<uint8_t> fileCosts;
+    std::vector<unsigned int> fileNodes(landmarks);
+    std::vector<unsigned int> fileUnits(landmarks);
+    std::vector<uint16_t> fileDistances((size_t) map.size() * landmarks);
+
+    file.read((char*) fileWalls.data(), fileWalls.size() * sizeof(uint64_t));
+    file.read((char*) &weighted, sizeof(weighted));
+
+    if(weighted) {
+        fileCosts.resize(map.size());
+        file.read((char*) fileCosts.data(), fileCosts.size());
+    }
+
+    file.read((char*) fileNodes.data(), landmarks * sizeof(unsigned int));
+    file.read((char*) fileUnits.data(), landmarks * sizeof(unsigned int));
+    file.read((char*) fileDistances.data(), fileDistances.size() * sizeof(uint16_t));
+
+    if(!file) {
+        return false;
+    }
+
+    rows = fileRows;
+    columns = fileColumns;
+    cutCorners = corners != 0;
+    walls.swap(fileWalls);
+    costs.swap(fileCosts);
+    checkedCosts = map.costVersion - 1;
+    nodes.swap(fileNodes);
+    units.swap(fileUnits);
+    distances.swap(fileDistances);
+    return true;
+}
+
+// Returns a cell of the largest connected region, or none if there are no
+// free cells
+unsigned int Landmarks::largestRegion(const Map& map) const {
+    std::vector<bool> seen(map.size(), false);
+    std::vector<unsigned int> stack;
+    unsigned int best = Map::none;
+    unsigned int bestSize = 0;
+
+    for(unsigned int node = 0; node < map.size(); ++node) {
+        if(seen[node] || map.wall(node)) {
+            continue;
+        }
+
+        unsigned int size = 0;
+        seen[node] = true;
+        stack.push_back(node);
+
+        while(!stack.empty()) {
+            unsigned int cell = stack.back();
+            stack.pop_back();
+            ++size;
+
+            map.forEachNeighbour(cell, [&](unsigned int neighbour, unsigned int) {
+                if(!seen[neighbour]) {
+                    seen[neighbour] = true;
+                    stack.push_back(neighbour);
+                }
+            });
+        }
+
+        if(size > bestSize) {
+            best = node;
+            bestSize = size;
+        }
+    }
+
+    return best;
+}
+
+void Landmarks::dijkstra(const Map& map, unsigned int source, std::vector<unsigned int>& distance) const {
+    OpenList open;
+    open.resize(map.size());
+    distance.assign(map.size(), Map::infinity);
+    distance[source] = 0;
+    open.push(source, 0);
+
+    while(!open.empty()) {
+        unsigned int node = open.pop();
+
+        map.forEachNeighbour(node, [&](unsigned int neighbour, unsigned int cost) {
+            if(distance[node] + cost < distance[neighbour]) {
+                distance[neighbour] = distance[node] + cost;
+                open.push(neighbour, distance[neighbour]);
+            }
+        });
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef __Pathfinding__Landmarks__
+#define __Pathfinding__Landmarks__
+
+#include "Map.h"
+#include <algorithm>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// Distance tables from a few landmark cells, for the ALT heuristic. By the
+// triangle inequality |d(L, a) - d(L, b)| never overestimates d(a, b), and
+// around walls it is far tighter than any straight-line distance.
+//
+// Distances are stored as 16-bit values, all landmarks of a cell next to each
+// other. A landmark whose distances don't fit counts in coarser units, and
+// its bound is scaled down so the heuristic stays consistent.
+class Landmarks {
+public:
+    static const uint16_t unreachable = 0xFFFF;
+
+    Landmarks(unsigned int count = 8) : count(count), rows(0), columns(0), cutCorners(false), checkedCosts(0) {}
+
+    // Picks landmarks far from each other and runs Dijkstra from each
+    void build(const Map& map);
+
+    // Adding walls or raising costs only makes distances longer, so the tables
+    // stay admissible and consistent. They have to be rebuilt once a move they
+    // didn't know about becomes possible or a cell gets cheaper.
+    bool stale(const Map& map) const;
+
+    // Returns false if the file can't be read or is for a map of another size
+    bool save(const std::string& path) const;
+    bool load(const std::string& path, const Map& map);
+    bool write(std::ostream& file) const;
+    bool read(std::istream& file, const Map& map);
+
+    unsigned int lowerBound(unsigned int a, unsigned int b) const;
+
+    unsigned int count;
+    std::vector<unsigned int> nodes;
+
+private:
+    unsigned int largestRegion(const Map& map) const;
+    void dijkstra(const Map& map, unsigned int source, std::vector<unsigned int>& distance) const;
+
+    std::vector<uint16_t> distances;
+    std::vector<unsigned int> units;
+
+    // The map the tables were built for
+    unsigned int rows;
+    unsigned int columns;
+    bool cutCorners;
+    std::vector<uint64_t> walls;
+    std::vector<uint8_t> costs;
+
+    // The map's cost version when the costs were last found not lowered
+    mutable unsigned int checkedCosts;
+};
+
+inline unsigned int Landmarks::lowerBound(unsigned int a, unsigned int b) const {
+    unsigned int landmarks = (unsigned int) nodes.size();
+    const uint16_t* fromA = distances.data() + (size_t) a * landmarks;
+    const uint16_t* fromB = distances.data() + (size_t) b * landmarks;
+    unsigned int bound = 0;
+
+    for(unsigned int k = 0; k < landmarks; ++k) {
+        if(fromA[k] == unreachable || fromB[k] == unreachable || fromA[k] == fromB[k]) {
+            continue;
+        }
+
+        unsigned int difference = fromA[k] > fromB[k] ? fromA[k] - fromB[k] : fromB[k] - fromA[k];
+
+        // Both values were rounded down to whole units, which lets the bound
+        // drop by up to unit - 1 more than a move costs. Scaling it by the
+        // cheapest move, 10, over 10 + unit - 1 takes that back.
+        unsigned int unit = units[k];
+        unsigned int rounded = unit * difference - (unit - 1);
+        bound = std::max(bound, unit == 1 ? rounded : (unsigned int) ((uint64_t) rounded * 10 / (unit + 9)));
+    }
+
+    return bound;
+}
+
+#endif /* defined(__Pathfinding__Landmarks__) */
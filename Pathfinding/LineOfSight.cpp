@@ -0,0 +1,92 @@
+#include "LineOfSight.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+// Whether the cells [first, last] are all free
+static bool runFree(const Map& map, unsigned int first, unsigned int last) {
+    for(unsigned int word = first >> 6; word <= last >> 6; ++word) {
+        unsigned int low = word == first >> 6 ? first & 63 : 0;
+        unsigned int high = word == last >> 6 ? last & 63 : 63;
+        uint64_t mask = (~(uint64_t) 0 << low) & (~(uint64_t) 0 >> (63 - high));
+
+        if(map.walls[word] & mask) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool lineOfSight(const Map& map, unsigned int a, unsigned int b) {
+    int i = map.column(a);
+    int j = map.row(a);
+    int di = std::abs((int) map.column(b) - i);
+    int dj = std::abs((int) map.row(b) - j);
+    int si = (int) map.column(b) > i ? 1 : -1;
+    int sj = (int) map.row(b) > j ? 1 : -1;
+
+    if(dj == 0) {
+        return runFree(map, std::min(a, b), std::max(a, b));
+    }
+
+    if(map.wall(a)) {
+        return false;
+    }
+
+    // error is proportional to how far the segment passes above the corner
+    // ahead of the current cell: positive steps across, negative down, zero
+    // through the corner
+    int error = di - dj;
+    int steps = di + dj;
+
+    while(steps > 0) {
+        if(error > 0) {
+            i += si;
+            error -= 2 * dj;
+            --steps;
+        } else if(error < 0) {
+            j += sj;
+            error += 2 * di;
+            --steps;
+        } else {
+            if(!map.cutCorners && (map.wall(map.index(i + si, j)) || map.wall(map.index(i, j + sj)))) {
+                return false;
+            }
+
+            i += si;
+            j += sj;
+            error += 2 * (di - dj);
+            steps -= 2;
+        }
+
+        if(map.wall(map.index(i, j))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+unsigned int lineLength(const Map& map, unsigned int a, unsigned int b) {
+    double di = (double) map.column(a) - map.column(b);
+    double dj = (double) map.row(a) - map.row(b);
+    return (unsigned int) (std::sqrt(di * di + dj * dj) * 10 + 0.5);
+}
+
+std::vector<unsigned int> pullString(const Map& map, const std::vector<unsigned int>& path) {
+    if(map.weighted() || path.size() <= 2) {
+        return path;
+    }
+
+    std::vector<unsigned int> corners(1, path.front());
+
+    for(unsigned int k = 1; k + 1 < path.size(); ++k) {
+        if(!lineOfSight(map, corners.back(), path[k + 1])) {
+            corners.push_back(path[k]);
+        }
+    }
+
+    corners.push_back(path.back());
+    return corners;
+}
@@ -0,0 +1,23 @@
+#ifndef __Pathfinding__LineOfSight__
+#define __Pathfinding__LineOfSight__
+
+#include "Map.h"
+#include <vector>
+
+// Whether the segment between the centres of two cells only crosses free
+// cells. Every cell the segment touches is checked, as in a supercover line
+// walked with Bresenham's integer error term. Where it passes exactly through
+// a corner, the two cells beside it block it unless the map cuts corners, as
+// for diagonal moves. Rows are checked a word of the wall bitset at a time.
+bool lineOfSight(const Map& map, unsigned int a, unsigned int b);
+
+// The straight-line distance between two cell centres in the map's units of
+// 10 per cell, rounded
+unsigned int lineLength(const Map& map, unsigned int a, unsigned int b);
+
+// String pulling: drops every cell of a path that the one before it can see
+// past, leaving the corners. Paths on maps with cell costs are returned as
+// they are, since a straight line would ignore the costs it crosses.
+std::vector<unsigned int> pullString(const Map& map, const std::vector<unsigned int>& path);
+
+#endif /* defined(__Pathfinding__LineOfSight__) */
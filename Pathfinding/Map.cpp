@@ -0,0 +1,313 @@
+#include "Map.h"
+#include "Search.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+#include <cstring>
+
+const unsigned int Map::none;
+const unsigned int Map::infinity;
+constexpr int Map::directionI[8];
+constexpr int Map::directionJ[8];
+constexpr unsigned int Map::directionCost[8];
+
+Map::Map(unsigned int rows, unsigned int columns)
+: costVersion(0),
+  algorithm(nullptr),
+  cutCorners(true),
+  rows(rows),
+  columns(columns),
+  edits(0),
+  dirtyI0(0),
+  dirtyJ0(0),
+  dirtyI1(0),
+  dirtyJ1(0),
+  dirtyNode(none),
+  dirtyCosts(false)
+{
+    walls.assign((size() + 63) / 64, 0);
+
+    start = index(std::min(3u, columns - 1), std::min(3u, rows - 1));
+    goal = index(std::min(8u, columns - 1), std::min(8u, rows - 1));
+    updateHeuristics();
+}
+
+void Map::clearWalls() {
+    fillWalls(0, 0, columns, rows, false);
+}
+
+// Heuristics are worked out when a search asks for them, so starting a
+// query doesn't touch every cell
+void Map::updateHeuristics() {
+    if(algorithm != nullptr) {
+        algorithm->reset();
+        algorithm->run();
+    }
+}
+
+unsigned int Map::movCost(unsigned int n1, unsigned int n2) {
+    return edgeCost(column(n1) != column(n2) && row(n1) != row(n2) ? 14 : 10, n1, n2);
+}
+
+bool Map::getWall(unsigned int i, unsigned int j) {
+    return wall(index(i, j));
+}
+
+void Map::setWall(unsigned int i, unsigned int j, bool wall) {
+    unsigned int node = index(i, j);
+
+    if(this->wall(node) == wall) {
+        return;
+    }
+
+    if(wall) {
+        walls[node >> 6] |= (uint64_t) 1 << (node & 63);
+        components.wallAdded(*this, node);
+    } else {
+        walls[node >> 6] &= ~((uint64_t) 1 << (node & 63));
+        components.wallRemoved(*this, node);
+    }
+
+    edited(i, j, i + 1, j + 1, node, false);
+}
+
+void Map::setStart(unsigned int i, unsigned int j) {
+    setWall(i, j, false);
+    start = index(i, j);
+
+    if(algorithm != nullptr) {
+        algorithm->startChanged();
+    } else {
+        updateHeuristics();
+    }
+}
+
+void Map::setGoal(unsigned int i, unsigned int j) {
+    setWall(i, j, false);
+    goal = index(i, j);
+
+    if(algorithm != nullptr) {
+        algorithm->goalChanged();
+    } else {
+        updateHeuristics();
+    }
+}
+
+void Map::setCost(unsigned int i, unsigned int j, uint8_t cost) {
+    fillCosts(i, j, i + 1, j + 1, cost);
+}
+
+void Map::fillCosts(unsigned int i0, unsigned int j0, unsigned int i1, unsigned int j1, uint8_t cost) {
+    cost = std::max<uint8_t>(cost, 1);
+
+    if(!clip(i0, j0, i1, j1) || (costs.empty() && cost == 1)) {
+        return;
+    }
+
+    if(costs.empty()) {
+        costs.assign(size(), 1);
+    }
+
+    for(unsigned int j = j0; j < j1; ++j) {
+        std::memset(&costs[index(i0, j)], cost, i1 - i0);
+    }
+
+    costsChanged(i0, j0, i1, j1);
+}
+
+void Map::adjustCosts(unsigned int i0, unsigned int j0, unsigned int i1, unsigned int j1, int delta) {
+    if(!clip(i0, j0, i1, j1) || delta == 0 || (costs.empty() && delta < 0)) {
+        return;
+    }
+
+    if(costs.empty()) {
+        costs.assign(size(), 1);
+    }
+
+    uint8_t amount = (uint8_t) std::min(std::abs(delta), 255);
+
+    for(unsigned int j = j0; j < j1; ++j) {
+        uint8_t* row = &costs[index(i0, j)];
+        unsigned int width = i1 - i0;
+
+        if(delta > 0) {
+            for(unsigned int k = 0; k < width; ++k) {
+                uint8_t sum = row[k] + amount;
+                row[k] = sum < amount ? 255 : sum;
+            }
+        } else {
+            for(unsigned int k = 0; k < width; ++k) {
+                row[k] = row[k] > amount ? row[k] - amount : 0;
+                row[k] = row[k] < 1 ? 1 : row[k];
+            }
+        }
+    }
+
+    costsChanged(i0, j0, i1, j1);
+}
+
+void Map::clearCosts() {
+    if(!costs.empty()) {
+        std::vector<uint8_t>().swap(costs);
+        costsChanged(0, 0, columns, rows);
+    }
+}
+
+bool Map::clip(unsigned int& i0, unsigned int& j0, unsigned int& i1, unsigned int& j1) const {
+    i1 = std::min(i1, columns);
+    j1 = std::min(j1, rows);
+    return i0 < i1 && j0 < j1;
+}
+
+void Map::costsChanged(unsigned int i0, unsigned int j0, unsigned int i1, unsigned int j1) {
+    ++costVersion;
+    edited(i0, j0, i1, j1, none, true);
+}
+
+void Map::beginEdit() {
+    ++edits;
+}
+
+void Map::commitEdit() {
+    if(edits > 0 && --edits == 0) {
+        notify();
+    }
+}
+
+void Map::paintWalls(unsigned int i, unsigned int j, unsigned int radius, bool wall) {
+    beginEdit();
+
+    for(int dj = -(int) radius; dj <= (int) radius; ++dj) {
+        int half = (int) std::sqrt((double) ((int) (radius * radius) - dj * dj));
+        int row = (int) j + dj;
+        int left = std::max((int) i - half, 0);
+
+        if(row >= 0) {
+            fillWalls(left, row, i + half + 1, row + 1, wall);
+        }
+    }
+
+    commitEdit();
+}
+
+// Small regions keep the components up to date cell by cell
+void Map::fillWalls(unsigned int i0, unsigned int j0, unsigned int i1, unsigned int j1, bool wall) {
+    if(!clip(i0, j0, i1, j1)) {
+        return;
+    }
+
+    if((i1 - i0) * (j1 - j0) <= 64) {
+        beginEdit();
+
+        for(unsigned int j = j0; j < j1; ++j) {
+            for(unsigned int i = i0; i < i1; ++i) {
+                setWall(i, j, wall);
+            }
+        }
+
+        commitEdit();
+        return;
+    }
+
+    bool changed = false;
+
+    for(unsigned int j = j0; j < j1; ++j) {
+        changed = walls.fill(index(i0, j), index(i1, j), wall) || changed;
+    }
+
+    if(changed) {
+        components.invalidate();
+        edited(i0, j0, i1, j1, none, false);
+    }
+}
+
+void Map::writeWalls(unsigned int i0, unsigned int j0, unsigned int width, unsigned int height, const uint64_t* bits) {
+    unsigned int i1 = i0 + width;
+    unsigned int j1 = j0 + height;
+    unsigned int changed = 0;
+    unsigned int last = none;
+
+    if(!clip(i0, j0, i1, j1)) {
+        return;
+    }
+
+    for(unsigned int j = j0; j < j1; ++j) {
+        for(unsigned int i = i0; i < i1; ++i) {
+            unsigned int k = (j - j0) * width + (i - i0);
+            bool wall = (bits[k >> 6] >> (k & 63)) & 1;
+            unsigned int node = index(i, j);
+
+            if(this->wall(node) == wall) {
+                continue;
+            }
+
+            walls[node >> 6] ^= (uint64_t) 1 << (node & 63);
+            last = node;
+
+            if(++changed > 64) {
+                components.invalidate();
+            } else if(wall) {
+                components.wallAdded(*this, node);
+            } else {
+                components.wallRemoved(*this, node);
+            }
+        }
+    }
+
+    if(changed > 0) {
+        edited(i0, j0, i1, j1, changed == 1 ? last : none, false);
+    }
+}
+
+// Grows the dirty rectangle, and commits it unless an edit is open
+void Map::edited(unsigned int i0, unsigned int j0, unsigned int i1, unsigned int j1, unsigned int node, bool cost) {
+    if(dirtyI0 >= dirtyI1) {
+        dirtyI0 = i0;
+        dirtyJ0 = j0;
+        dirtyI1 = i1;
+        dirtyJ1 = j1;
+        dirtyNode = node;
+    } else {
+        dirtyI0 = std::min(dirtyI0, i0);
+        dirtyJ0 = std::min(dirtyJ0, j0);
+        dirtyI1 = std::max(dirtyI1, i1);
+        dirtyJ1 = std::max(dirtyJ1, j1);
+        dirtyNode = none;
+    }
+
+    dirtyCosts = dirtyCosts || cost;
+
+    if(edits == 0) {
+        notify();
+    }
+}
+
+// A lone wall goes to the incremental wallChanged. Cost updates cover the
+// walls changed with them.
+void Map::notify() {
+    if(dirtyI0 >= dirtyI1) {
+        return;
+    }
+
+    unsigned int i0 = dirtyI0;
+    unsigned int j0 = dirtyJ0;
+    unsigned int i1 = dirtyI1;
+    unsigned int j1 = dirtyJ1;
+    unsigned int node = dirtyNode;
+    bool cost = dirtyCosts;
+
+    dirtyI0 = 0;
+    dirtyI1 = 0;
+    dirtyNode = none;
+    dirtyCosts = false;
+
+    if(algorithm == nullptr) {
+        updateHeuristics();
+    } else if(cost) {
+        algorithm->costsChanged(i0, j0, i1, j1);
+    } else if(node != none) {
+        algorithm->wallChanged(node);
+    } else {
+        algorithm->wallsChanged(i0, j0, i1, j1);
+    }
+}
@@ -0,0 +1,142 @@
+#ifndef __Pathfinding__Map__
+#define __Pathfinding__Map__
+
+#include "Bitset.h"
+#include "Components.h"
+#include <cstdint>
+#include <vector>
+
+class PFAlgorithm;
+
+// Cells are stored contiguously and addressed by index = j * columns + i.
+// Walls are a bitset, which may be a view of a mapped file. Search state
+// belongs to the algorithm's Workspace.
+//
+// Cells may also have a traversal cost from 1 to 255. A move costs 10 or 14
+// times the mean of the costs of the two cells, so it is the same both ways
+// and never below the straight-line heuristics.
+class Map {
+public:
+    static const unsigned int none = 0xFFFFFFFF;
+    static const unsigned int infinity = 0xFFFFFFFF;
+
+    // 8-connected moves, orthogonal ones first
+    static constexpr int directionI[8] = { 1, 0, -1, 0, 1, -1, -1, 1 };
+    static constexpr int directionJ[8] = { 0, 1, 0, -1, 1, 1, -1, -1 };
+    static constexpr unsigned int directionCost[8] = { 10, 10, 10, 10, 14, 14, 14, 14 };
+
+    Map(unsigned int rows, unsigned int columns);
+
+    Bitset walls;
+
+    // Empty while every cell costs 1. Edited through the cost functions, which
+    // bump costVersion.
+    std::vector<uint8_t> costs;
+    unsigned int costVersion;
+
+    unsigned int start;
+    unsigned int goal;
+    PFAlgorithm* algorithm;
+    bool cutCorners;
+
+    unsigned int rows;
+    unsigned int columns;
+
+    // Labels are brought up to date by searches; see Components
+    mutable Components components;
+
+    unsigned int size() const { return rows * columns; }
+    unsigned int index(unsigned int i, unsigned int j) const { return j * columns + i; }
+    unsigned int column(unsigned int index) const { return index % columns; }
+    unsigned int row(unsigned int index) const { return index / columns; }
+    bool wall(unsigned int index) const { return (walls[index >> 6] >> (index & 63)) & 1; }
+    bool weighted() const { return !costs.empty(); }
+    unsigned int cost(unsigned int index) const { return costs.empty() ? 1 : costs[index]; }
+    unsigned int edgeCost(unsigned int base, unsigned int n1, unsigned int n2) const;
+
+    bool connected(unsigned int a, unsigned int b) const { return components.connected(*this, a, b); }
+    void updateComponents() const { components.update(*this); }
+
+    template<typename Visitor>
+    void forEachNeighbour(unsigned int node, Visitor visit) const;
+
+    unsigned int movCost(unsigned int n1, unsigned int n2);
+    bool getWall(unsigned int i, unsigned int j);
+    void setWall(unsigned int i, unsigned int j, bool wall);
+    void setStart(unsigned int i, unsigned int j);
+    void setGoal(unsigned int i, unsigned int j);
+    void clearWalls();
+    void updateHeuristics();
+
+    // Wall and cost writes between beginEdit and commitEdit only grow a dirty
+    // rectangle; the commit tells the algorithm once, so a batch costs one
+    // recomputation. Edits nest. Outside of one every write commits at once.
+    // Moving the start or goal isn't deferred.
+    void beginEdit();
+    void commitEdit();
+
+    // A disc brush, a rectangle, and a width x height bitmap whose bit k is
+    // in word k / 64. Large writes relabel the components from scratch.
+    void paintWalls(unsigned int i, unsigned int j, unsigned int radius, bool wall);
+    void fillWalls(unsigned int i0, unsigned int j0, unsigned int i1, unsigned int j1, bool wall);
+    void writeWalls(unsigned int i0, unsigned int j0, unsigned int width, unsigned int height, const uint64_t* bits);
+
+    // Regions are the cells [i0, i1) x [j0, j1), clipped to the map. Rows are
+    // filled with memset and adjusted in loops the compiler vectorizes into
+    // saturating byte arithmetic.
+    void setCost(unsigned int i, unsigned int j, uint8_t cost);
+    void fillCosts(unsigned int i0, unsigned int j0, unsigned int i1, unsigned int j1, uint8_t cost);
+    void adjustCosts(unsigned int i0, unsigned int j0, unsigned int i1, unsigned int j1, int delta);
+    void clearCosts();
+
+private:
+    bool clip(unsigned int& i0, unsigned int& j0, unsigned int& i1, unsigned int& j1) const;
+    void costsChanged(unsigned int i0, unsigned int j0, unsigned int i1, unsigned int j1);
+    void edited(unsigned int i0, unsigned int j0, unsigned int i1, unsigned int j1, unsigned int node, bool cost);
+    void notify();
+
+    // The open edits and what they changed. dirtyNode is the changed cell
+    // while there is only one.
+    unsigned int edits;
+    unsigned int dirtyI0;
+    unsigned int dirtyJ0;
+    unsigned int dirtyI1;
+    unsigned int dirtyJ1;
+    unsigned int dirtyNode;
+    bool dirtyCosts;
+};
+
+inline unsigned int Map::edgeCost(unsigned int base, unsigned int n1, unsigned int n2) const {
+    return costs.empty() ? base : base * (costs[n1] + costs[n2]) / 2;
+}
+
+// Calls visit(neighbour, cost) for every free cell reachable in one move.
+// Diagonal moves squeezing past a wall are skipped unless cutCorners is set.
+template<typename Visitor>
+inline void Map::forEachNeighbour(unsigned int node, Visitor visit) const {
+    int i = column(node);
+    int j = row(node);
+
+    for(unsigned int d = 0; d < 8; ++d) {
+        int ni = i + directionI[d];
+        int nj = j + directionJ[d];
+
+        if(ni < 0 || nj < 0 || ni >= (int) columns || nj >= (int) rows) {
+            continue;
+        }
+
+        unsigned int neighbour = nj * columns + ni;
+
+        if(wall(neighbour)) {
+            continue;
+        }
+
+        if(d >= 4 && !cutCorners && (wall(j * columns + ni) || wall(nj * columns + i))) {
+            continue;
+        }
+
+        visit(neighbour, edgeCost(directionCost[d], node, neighbour));
+    }
+}
+
+#endif /* defined(__Pathfinding__Map__) */
@@ -0,0 +1,284 @@
+#include "MapFile.h"
+#include "Landmarks.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const uint32_t MapFile::version;
+const uint32_t MapFile::byteOrderMark;
+
+static const char magic[4] = { 'P', 'F', 'M', 'P' };
+static const size_t alignment = 64;
+
+static size_t aligned(size_t offset) {
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+// Keeps the start and goal on free cells of the map. Ones that are off the
+// map or on a wall move to the first and last free cells.
+static void place(Map& map, unsigned int start, unsigned int goal) {
+    unsigned int first = Map::none;
+    unsigned int last = Map::none;
+
+    for(unsigned int node = 0; node < map.size() && first == Map::none; ++node) {
+        if(!map.wall(node)) first = node;
+    }
+
+    for(unsigned int node = map.size(); node > 0 && last == Map::none; --node) {
+        if(!map.wall(node - 1)) last = node - 1;
+    }
+
+    map.start = start < map.size() && !map.wall(start) ? start : (first != Map::none ? first : 0);
+    map.goal = goal < map.size() && !map.wall(goal) ? goal : (last != Map::none ? last : 0);
+    map.walls[map.start >> 6] &= ~((uint64_t) 1 << (map.start & 63));
+    map.walls[map.goal >> 6] &= ~((uint64_t) 1 << (map.goal & 63));
+
+    ++map.costVersion;
+    map.components.invalidate();
+    map.updateHeuristics();
+}
+
+bool MapFile::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+
+    if(fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+
+    if(fstat(fd, &info) != 0 || (size_t) info.st_size < sizeof(Header)) {
+        ::close(fd);
+        return false;
+    }
+
+    size_t length = (size_t) info.st_size;
+    void* memory = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+
+    if(memory == MAP_FAILED) {
+        return false;
+    }
+
+    data = std::shared_ptr<void>(memory, [length](void* memory) { munmap(memory, length); });
+    size = length;
+
+    const Header* h = header();
+    const Entry* entries = (const Entry*) (h + 1);
+
+    if(!std::equal(magic, magic + 4, h->magic) || h->byteOrder != byteOrderMark || h->version != version ||
+       sizeof(Header) + (size_t) h->sections * sizeof(Entry) > size)
+    {
+        close();
+        return false;
+    }
+
+    for(unsigned int s = 0; s < h->sections; ++s) {
+        if(entries[s].offset % alignment != 0 || entries[s].offset > size || entries[s].size > size - entries[s].offset) {
+            close();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void MapFile::close() {
+    data.reset();
+    size = 0;
+}
+
+bool MapFile::load(Map& map) const {
+    size_t bytes = 0;
+    const void* bits = section(walls, bytes);
+
+    if(bits == nullptr) {
+        return false;
+    }
+
+    const Header* h = header();
+    unsigned int words = (unsigned int) (((uint64_t) h->rows * h->columns + 63) / 64);
+
+    if(h->rows == 0 || h->columns == 0 || bytes != (size_t) words * sizeof(uint64_t)) {
+        return false;
+    }
+
+    const uint8_t* costBytes = (const uint8_t*) section(costs, bytes);
+
+    if(costBytes != nullptr && bytes != (size_t) h->rows * h->columns) {
+        return false;
+    }
+
+    map.rows = h->rows;
+    map.columns = h->columns;
+    map.walls.view((uint64_t*) bits, words, data);
+
+    if(costBytes != nullptr) {
+        map.costs.assign(costBytes, costBytes + bytes);
+    } else {
+        map.costs.clear();
+    }
+
+    place(map, h->start, h->goal);
+    return true;
+}
+
+const void* MapFile::section(Section type, size_t& bytes) const {
+    if(data == nullptr) {
+        return nullptr;
+    }
+
+    const Header* h = header();
+    const Entry* entries = (const Entry*) (h + 1);
+
+    for(unsigned int s = 0; s < h->sections; ++s) {
+        if(entries[s].type == type) {
+            bytes = (size_t) entries[s].size;
+            return (const char*) data.get() + entries[s].offset;
+        }
+    }
+
+    return nullptr;
+}
+
+// Lets the tables be read straight out of the mapped section
+struct SectionBuffer : std::streambuf {
+    SectionBuffer(const void* data, size_t bytes) {
+        char* begin = (char*) data;
+        setg(begin, begin, begin + bytes);
+    }
+};
+
+bool MapFile::loadLandmarks(Landmarks& tables, const Map& map) const {
+    size_t bytes = 0;
+    const void* data = section(landmarks, bytes);
+
+    if(data == nullptr) {
+        return false;
+    }
+
+    SectionBuffer buffer(data, bytes);
+    std::istream stream(&buffer);
+    return tables.read(stream, map);
+}
+
+bool MapFile::save(const std::string& path, const Map& map, const Landmarks* tables) {
+    std::vector<Entry> entries;
+    std::vector<const char*> contents;
+    std::string landmarkBytes;
+
+    entries.push_back(Entry{walls, 0, 0, (uint64_t) map.walls.size() * sizeof(uint64_t)});
+    contents.push_back((const char*) map.walls.data());
+
+    if(map.weighted()) {
+        entries.push_back(Entry{costs, 0, 0, map.costs.size()});
+        contents.push_back((const char*) map.costs.data());
+    }
+
+    if(tables != nullptr) {
+        std::ostringstream stream;
+
+        if(!tables->write(stream)) {
+            return false;
+        }
+
+        landmarkBytes = stream.str();
+        entries.push_back(Entry{landmarks, 0, 0, landmarkBytes.size()});
+        contents.push_back(landmarkBytes.data());
+    }
+
+    size_t offset = aligned(sizeof(Header) + entries.size() * sizeof(Entry));
+
+    for(Entry& entry : entries) {
+        entry.offset = offset;
+        offset = aligned(offset + entry.size);
+    }
+
+    Header h;
+    std::memcpy(h.magic, magic, sizeof(magic));
+    h.version = version;
+    h.columns = map.columns;
+    h.rows = map.rows;
+    h.start = map.start;
+    h.goal = map.goal;
+    h.sections = (uint32_t) entries.size();
+    h.byteOrder = byteOrderMark;
+
+    std::ofstream file(path.c_str(), std::ios::binary);
+    file.write((const char*) &h, sizeof(h));
+    file.write((const char*) entries.data(), entries.size() * sizeof(Entry));
+
+    const char padding[alignment] = { 0 };
+    size_t written = sizeof(Header) + entries.size() * sizeof(Entry);
+
+    for(unsigned int s = 0; s < entries.size(); ++s) {
+        file.write(padding, entries[s].offset - written);
+        file.write(contents[s], entries[s].size);
+        written = entries[s].offset + entries[s].size;
+    }
+
+    return file.good();
+}
+
+// The format is a few "key value" lines, a line saying "map", then one line
+// of characters per row
+bool MapFile::importMovingAI(const std::string& path, Map& map) {
+    std::ifstream file(path.c_str(), std::ios::binary);
+    std::string key;
+    unsigned int height = 0;
+    unsigned int width = 0;
+
+    while(file >> key && key != "map") {
+        if(key == "height") {
+            file >> height;
+        } else if(key == "width") {
+            file >> width;
+        } else {
+            file >> key;
+        }
+    }
+
+    if(!file || height == 0 || width == 0) {
+        return false;
+    }
+
+    std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    size_t position = 0;
+
+    map.rows = height;
+    map.columns = width;
+    map.walls.assign((map.size() + 63) / 64, 0);
+    map.costs.clear();
+
+    for(unsigned int j = 0; j < height; ++j) {
+        while(position < text.size() && (text[position] == '\n' || text[position] == '\r')) {
+            ++position;
+        }
+
+        if(text.size() - position < width) {
+            place(map, Map::none, Map::none);
+            return false;
+        }
+
+        for(unsigned int i = 0; i < width; ++i) {
+            char c = text[position + i];
+
+            if(c != '.' && c != 'G' && c != 'S') {
+                unsigned int node = map.index(i, j);
+                map.walls[node >> 6] |= (uint64_t) 1 << (node & 63);
+            }
+        }
+
+        position += width;
+    }
+
+    place(map, Map::none, Map::none);
+    return true;
+}
@@ -0,0 +1,78 @@
+#ifndef __Pathfinding__MapFile__
+#define __Pathfinding__MapFile__
+
+#include "Map.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+class Landmarks;
+
+// Packed map files. A 32-byte header (magic "PFMP", version, columns, rows,
+// start, goal, section count, byte order) is followed by a table of sections,
+// each given as type, offset and size. Sections start on 64-byte boundaries.
+//
+// The wall section holds the bitset exactly as Map keeps it, so loading maps
+// the file and points the walls at it instead of parsing anything. The
+// optional cost section, one byte per cell, is copied. Pages are
+// mapped private: edits to a loaded map never reach the file. Numbers are
+// in the byte order of the machine that wrote the file. The byte order field
+// holds byteOrderMark, so a machine of the other order rejects the file
+// instead of misreading it.
+class MapFile {
+public:
+    static const uint32_t version = 2;
+    static const uint32_t byteOrderMark = 0x01020304;
+
+    enum Section : uint32_t { walls = 1, costs = 2, landmarks = 3 };
+
+    MapFile() : size(0) {}
+
+    bool open(const std::string& path);
+    void close();
+
+    // Points the map at the walls and sets its size, start and goal
+    bool load(Map& map) const;
+
+    unsigned int rows() const { return header()->rows; }
+    unsigned int columns() const { return header()->columns; }
+
+    // Returns the section's bytes, or nullptr if the file has none
+    const void* section(Section type, size_t& bytes) const;
+
+    // Reads the landmark section for a loaded map
+    bool loadLandmarks(Landmarks& landmarks, const Map& map) const;
+
+    static bool save(const std::string& path, const Map& map, const Landmarks* landmarks = nullptr);
+
+    // Reads the text maps of the MovingAI benchmarks. Only '.', 'G' and 'S'
+    // are passable.
+    static bool importMovingAI(const std::string& path, Map& map);
+
+private:
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint32_t columns;
+        uint32_t rows;
+        uint32_t start;
+        uint32_t goal;
+        uint32_t sections;
+        uint32_t byteOrder;
+    };
+
+    struct Entry {
+        uint32_t type;
+        uint32_t reserved;
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    const Header* header() const { return (const Header*) data.get(); }
+
+    std::shared_ptr<void> data;
+    size_t size;
+};
+
+#endif /* defined(__Pathfinding__MapFile__) */
@@ -0,0 +1,129 @@
+#include "OpenList.h"
+
+const unsigned int OpenList::none;
+
+void OpenList::resize(unsigned int nodes) {
+    clear();
+    position.assign(nodes, none);
+}
+
+void OpenList::clear() {
+    for(const Entry& entry : heap) {
+        position[entry.node] = none;
+    }
+
+    heap.clear();
+}
+
+bool OpenList::empty() const {
+    return heap.empty();
+}
+
+unsigned int OpenList::size() const {
+    return (unsigned int) heap.size();
+}
+
+bool OpenList::contains(unsigned int node) const {
+    return node < position.size() && position[node] != none;
+}
+
+void OpenList::push(unsigned int node, uint64_t key) {
+    unsigned int pos = position[node];
+
+    if(pos == none) {
+        pos = (unsigned int) heap.size();
+        heap.push_back(Entry{key, node});
+        position[node] = pos;
+        siftUp(pos);
+    } else if(key < heap[pos].key) {
+        heap[pos].key = key;
+        siftUp(pos);
+    } else {
+        heap[pos].key = key;
+        siftDown(pos);
+    }
+}
+
+void OpenList::remove(unsigned int node) {
+    unsigned int pos = position[node];
+
+    if(pos == none) {
+        return;
+    }
+
+    position[node] = none;
+    Entry last = heap.back();
+    heap.pop_back();
+
+    if(pos < heap.size()) {
+        heap[pos] = last;
+        position[last.node] = pos;
+        siftUp(pos);
+        siftDown(position[last.node]);
+    }
+}
+
+unsigned int OpenList::top() const {
+    return heap.front().node;
+}
+
+uint64_t OpenList::topKey() const {
+    return heap.front().key;
+}
+
+uint64_t OpenList::key(unsigned int node) const {
+    return heap[position[node]].key;
+}
+
+unsigned int OpenList::pop() {
+    unsigned int node = heap.front().node;
+    remove(node);
+    return node;
+}
+
+void OpenList::siftUp(unsigned int pos) {
+    Entry entry = heap[pos];
+
+    while(pos > 0) {
+        unsigned int parent = (pos - 1) / 2;
+
+        if(heap[parent].key <= entry.key) {
+            break;
+        }
+
+        heap[pos] = heap[parent];
+        position[heap[pos].node] = pos;
+        pos = parent;
+    }
+
+    heap[pos] = entry;
+    position[entry.node] = pos;
+}
+
+void OpenList::siftDown(unsigned int pos) {
+    Entry entry = heap[pos];
+    unsigned int size = (unsigned int) heap.size();
+
+    while(true) {
+        unsigned int child = 2 * pos + 1;
+
+        if(child >= size) {
+            break;
+        }
+
+        if(child + 1 < size && heap[child + 1].key < heap[child].key) {
+            ++child;
+        }
+
+        if(entry.key <= heap[child].key) {
+            break;
+        }
+
+        heap[pos] = heap[child];
+        position[heap[pos].node] = pos;
+        pos = child;
+    }
+
+    heap[pos] = entry;
+    position[entry.node] = pos;
+}
@@ -0,0 +1,40 @@
+#ifndef __Pathfinding__OpenList__
+#define __Pathfinding__OpenList__
+
+#include <cstdint>
+#include <vector>
+
+// Indexed binary min-heap over node indices. The position table makes
+// contains() O(1) and lets a queued node's key be changed in O(log n).
+class OpenList {
+public:
+    static const unsigned int none = 0xFFFFFFFF;
+
+    void resize(unsigned int nodes);
+    void clear();
+    bool empty() const;
+    unsigned int size() const;
+    bool contains(unsigned int node) const;
+
+    // Inserts the node, or moves it if it is already queued
+    void push(unsigned int node, uint64_t key);
+    void remove(unsigned int node);
+    unsigned int top() const;
+    uint64_t topKey() const;
+    uint64_t key(unsigned int node) const;
+    unsigned int pop();
+
+private:
+    struct Entry {
+        uint64_t key;
+        unsigned int node;
+    };
+
+    void siftUp(unsigned int pos);
+    void siftDown(unsigned int pos);
+
+    std::vector<Entry> heap;
+    std::vector<unsigned int> position;
+};
+
+#endif /* defined(__Pathfinding__OpenList__) */
@@ -1,4 +1,7 @@
 #include "Pathfinding.h"
+#include "MapFile.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
 const sf::Color dark = sf::Color(51, 51, 51, 255);
@@ -10,135 +13,93 @@ const sf::Color goalRed = sf::Color(196, 91, 91, 255);
 const sf::Color visitedBlue = sf::Color(145, 194, 216, 255);
 const sf::Color openBlue = sf::Color(77, 209, 255, 255);
 
-Node::Node(unsigned int width, unsigned int height, sf::Transformable* parent, const sf::Font& font)
-    : wall(false),
-    parent(parent),
-    cameFrom(nullptr),
-    heuristic(0),
-    gCost(1000),
-    fCost(1000)
+DigitAtlas::DigitAtlas(const sf::Font& font, unsigned int size)
+: font(font),
+  size(size)
 {
-    rect = sf::RectangleShape(sf::Vector2f(width, height));
-    rect.setFillColor(gridBg);
-    
-    heuristicLabel = sf::Text("", font, 9);
-    heuristicLabel.setColor(dark);
-    
-    gCostLabel = sf::Text("", font, 9);
-    gCostLabel.setColor(dark);
-    
-    fCostLabel = sf::Text("", font, 9);
-    fCostLabel.setColor(dark);
-}
-
-bool Node::getWall() {
-    return wall;
-}
-    
-void Node::setWall(bool wall) {
-    this->wall = wall;
-    
-    if(wall) {
-        rect.setFillColor(wallColor);
-    } else {
-        rect.setFillColor(gridBg);
-    }
-}
-    
-sf::Vector2f Node::center() {
-    return parent->getPosition() +
-            sf::Vector2f(rect.getPosition().x + rect.getLocalBounds().width / 2,
-                         rect.getPosition().y + rect.getLocalBounds().height / 2);
-}
-    
-bool Node::contains(sf::Vector2i point) {
-    return rect.getGlobalBounds().contains(sf::Vector2f(point.x, point.y) - parent->getPosition());
-}
-    
-void Node::link(Node* node) {
-    if(!this->getWall() && !node->getWall()) {
-        neighbours.push_back(node);
-        node->neighbours.push_back(this);
+    for(unsigned int d = 0; d < 10; ++d) {
+        glyphs[d] = font.getGlyph('0' + d, size, false);
     }
 }
 
-void Node::draw(sf::RenderTarget& target, sf::RenderStates states) const {
-    target.draw(rect, states);
-    target.draw(heuristicLabel, states);
-    target.draw(gCostLabel, states);
-    target.draw(fCostLabel, states);
+const sf::Texture& DigitAtlas::texture() const {
+    return font.getTexture(size);
 }
 
-void PFAlgorithm::iterate() {
-    ++iteration;
-    
-    grid.updateHeuristics();
-    reset();
-    run();
-}
-    
-void PFAlgorithm::rewind() {
-    if(iteration >= 1)
-        iteration -= 1;
-    
-    grid.updateHeuristics();
-    reset();
-    run();
-}
-
-void PFAlgorithm::reset() {
-    openSet.clear();
-    closedSet.clear();
+// Laid out like sf::Text: the baseline is size below the position and the
+// glyphs get a pixel of padding on each side
+void DigitAtlas::write(sf::Vertex* quads, unsigned int slots, unsigned int value, sf::Vector2f position, sf::Color color) const {
+    unsigned int digits[10];
+    unsigned int length = 0;
+    
+    for(unsigned int rest = value; value != blank && (length == 0 || rest > 0); rest /= 10) {
+        digits[length++] = rest % 10;
+    }
     
-    iterations = 0;
-}
-
-void PFAlgorithm::toStart() {
-    iteration = 0;
+    float x = position.x;
+    float y = position.y + size;
     
-    grid.updateHeuristics();
-    reset();
-    run();
-}
-
-void PFAlgorithm::toEnd() {
-    grid.updateHeuristics();
-    reset();
-    run(true);
+    for(unsigned int k = 0; k < slots; ++k) {
+        sf::Vertex* quad = quads + k * 4;
+        
+        if(k >= length) {
+            for(unsigned int v = 0; v < 4; ++v) {
+                quad[v] = sf::Vertex(position, sf::Color::Transparent);
+            }
+            
+            continue;
+        }
+        
+        const sf::Glyph& glyph = glyphs[digits[length - 1 - k]];
+        float left = x + glyph.bounds.left - 1;
+        float top = y + glyph.bounds.top - 1;
+        float right = left + glyph.bounds.width + 2;
+        float bottom = top + glyph.bounds.height + 2;
+        float u1 = glyph.textureRect.left - 1;
+        float v1 = glyph.textureRect.top - 1;
+        float u2 = u1 + glyph.textureRect.width + 2;
+        float v2 = v1 + glyph.textureRect.height + 2;
+        
+        quad[0] = sf::Vertex(sf::Vector2f(left, top), color, sf::Vector2f(u1, v1));
+        quad[1] = sf::Vertex(sf::Vector2f(right, top), color, sf::Vector2f(u2, v1));
+        quad[2] = sf::Vertex(sf::Vector2f(right, bottom), color, sf::Vector2f(u2, v2));
+        quad[3] = sf::Vertex(sf::Vector2f(left, bottom), color, sf::Vector2f(u1, v2));
+        x += glyph.advance;
+    }
 }
 
-NodeRef::NodeRef(Node* node, sf::Color color, sf::Transformable* parent)
-: node(node),
-  parent(parent),
+NodeRef::NodeRef(unsigned int index, sf::Vector2f position, sf::Vector2f size, sf::Color color)
+: index(index),
+  home(position),
   dragging(false)
 {
-    rect = sf::RectangleShape(sf::Vector2f(node->rect.getLocalBounds().width,
-                                           node->rect.getLocalBounds().height));
-    rect.setPosition(node->rect.getPosition());
+    rect = sf::RectangleShape(size);
+    rect.setPosition(position);
     rect.setFillColor(color);
 }
     
-bool NodeRef::contains(sf::Vector2i point) {
-    return rect.getGlobalBounds().contains(sf::Vector2f(point.x, point.y) - parent->getPosition());
+bool NodeRef::contains(sf::Vector2f point) {
+    return rect.getGlobalBounds().contains(point);
 }
     
-void NodeRef::moveToMousePosition(sf::Vector2f mousePos) {
+void NodeRef::moveToMousePosition(sf::Vector2f point) {
     if(!dragging) {
         dragging = true;
-        dragOffset = rect.getPosition() - (mousePos - parent->getPosition());
+        dragOffset = rect.getPosition() - point;
     }
     
-    rect.setPosition(dragOffset + (mousePos - parent->getPosition()));
+    rect.setPosition(dragOffset + point);
 }
     
 void NodeRef::moveToNode() {
-    rect.setPosition(node->rect.getPosition());
+    rect.setPosition(home);
     dragging = false;
 }
     
-void NodeRef::setNode(Node* node) {
-    this->node = node;
-    rect.setPosition(node->rect.getPosition());
+void NodeRef::setNode(unsigned int index, sf::Vector2f position) {
+    this->index = index;
+    home = position;
+    rect.setPosition(position);
     dragging = false;
 }
     
@@ -147,224 +108,428 @@ void NodeRef::draw(sf::RenderTarget& target, sf::RenderStates states) const {
 }
 
 
+// Cells are never laid out smaller than this; bigger maps start zoomed out
+static const unsigned int minimumPitch = 32;
+
 Grid::Grid(unsigned int rows, unsigned int columns, unsigned int width, unsigned int height, const sf::Font& font)
-: rows(rows),
+: map(rows, columns),
+  rows(rows),
   columns(columns),
   width(width),
   height(height),
-  algorithm(nullptr)
+  pitch(std::max(width / columns, minimumPitch), std::max(height / rows, minimumPitch)),
+  camera(0, 0),
+  zoom(1),
+  merged(sf::Quads),
+  labels(sf::Quads),
+  mergedFactor(0),
+  mergedVersion(0),
+  labelVersion(0),
+  version(1),
+  chunkColumns((columns + chunk - 1) / chunk),
+  digits(font, 9),
+  rate(0)
 {
     borderRect = sf::RectangleShape(sf::Vector2f(width + 1, height + 1));
     borderRect.setFillColor(borderColor);
+    zoom = std::min(1.f, fittingZoom());
     
-    unsigned int nodeW = (width / columns) - 1;
-    unsigned int nodeH = (height / rows) - 1;
+    // Chunks at the edges are padded with empty quads
+    unsigned int chunkRows = (rows + chunk - 1) / chunk;
+    cells.setPrimitiveType(sf::Quads);
+    cells.resize(chunkRows * chunkColumns * chunk * chunk * 4);
+    sf::Vector2f size = pitch - sf::Vector2f(1, 1);
     
     for(int j = 0; j < rows; ++j) {
         for(int i = 0; i < columns; ++i) {
-            Node* node = new Node(nodeW, nodeH, this, font);
-            node->rect.setPosition(1 + ((nodeW + 1) * i), 1 + ((nodeH + 1) * j));
-            node->heuristicLabel.setPosition(1 + ((nodeW + 1) * i), 1 + ((nodeH + 1) * j));
-            node->gCostLabel.setPosition(1 + ((nodeW + 1) * i), 11 + ((nodeH + 1) * j));
-            node->fCostLabel.setPosition(1 + ((nodeW + 1) * i), 21 + ((nodeH + 1) * j));
-            nodes[i][j] = node;
-            nodes[i][j]->i = i;
-            nodes[i][j]->j = j;
+            sf::Vector2f topLeft = position(map.index(i, j));
+            sf::Vertex* quad = &cells[vertex(i, j)];
+            quad[0].position = topLeft;
+            quad[1].position = topLeft + sf::Vector2f(size.x, 0);
+            quad[2].position = topLeft + size;
+            quad[3].position = topLeft + sf::Vector2f(0, size.y);
         }
     }
     
-    start = NodeRef(nodes[3][3], startGreen, this);
-    goal = NodeRef(nodes[8][8], goalRed, this);
-    updateHeuristics();
+    start = NodeRef(map.start, position(map.start), size, startGreen);
+    goal = NodeRef(map.goal, position(map.goal), size, goalRed);
+    updateNodes();
 }
     
 bool Grid::contains(sf::Vector2i point) {
     return borderRect.getGlobalBounds().contains(sf::Vector2f(point.x, point.y) - getPosition());
 }
 
+sf::Vector2f Grid::toGrid(sf::Vector2i point) const {
+    return camera + (sf::Vector2f(point.x, point.y) - getPosition()) / zoom;
+}
+
+bool Grid::cellAt(sf::Vector2i point, unsigned int& i, unsigned int& j) const {
+    sf::Vector2f local = sf::Vector2f(point.x, point.y) - getPosition();
+    sf::Vector2f p = toGrid(point);
+    
+    if(local.x < 0 || local.y < 0 || local.x > width || local.y > height || p.x < 0 || p.y < 0) {
+        return false;
+    }
+    
+    i = (unsigned int) (p.x / pitch.x);
+    j = (unsigned int) (p.y / pitch.y);
+    return i < columns && j < rows;
+}
+
+sf::Vector2f Grid::position(unsigned int index) const {
+    return sf::Vector2f(1 + pitch.x * map.column(index), 1 + pitch.y * map.row(index));
+}
+
+sf::Vector2f Grid::center(unsigned int index) const {
+    return position(index) + (pitch - sf::Vector2f(1, 1)) / 2.f;
+}
+
+sf::IntRect Grid::visibleCells() const {
+    sf::Vector2f size = sf::Vector2f(width + 1, height + 1) / zoom;
+    int left = std::max(0, (int) std::floor(camera.x / pitch.x));
+    int top = std::max(0, (int) std::floor(camera.y / pitch.y));
+    int right = std::min((int) columns, (int) std::ceil((camera.x + size.x) / pitch.x));
+    int bottom = std::min((int) rows, (int) std::ceil((camera.y + size.y) / pitch.y));
+    
+    return sf::IntRect(left, top, std::max(0, right - left), std::max(0, bottom - top));
+}
+
+// Assumes the target's view is its default one
+sf::View Grid::view(const sf::RenderTarget& target) const {
+    sf::Vector2f size(width + 1, height + 1);
+    sf::Vector2u targetSize = target.getSize();
+    sf::View view(sf::FloatRect(camera, size / zoom));
+    view.setViewport(sf::FloatRect(getPosition().x / targetSize.x, getPosition().y / targetSize.y,
+                                   size.x / targetSize.x, size.y / targetSize.y));
+    return view;
+}
+
+void Grid::pan(sf::Vector2f offset) {
+    camera -= offset / zoom;
+    clampCamera();
+}
+
+// Keeps the grid point under the cursor where it is
+void Grid::zoomAt(sf::Vector2i point, float factor) {
+    sf::Vector2f before = toGrid(point);
+    zoom = std::max(std::min(zoom * factor, 8.f), std::min(1.f, fittingZoom()) / 2);
+    camera += before - toGrid(point);
+    clampCamera();
+}
+
+float Grid::fittingZoom() const {
+    return std::min(width / (pitch.x * columns), height / (pitch.y * rows));
+}
+
+// The middle of the view stays over the map
+void Grid::clampCamera() {
+    sf::Vector2f half = sf::Vector2f(width + 1, height + 1) / (2 * zoom);
+    camera.x = std::max(-half.x, std::min(camera.x, pitch.x * columns - half.x));
+    camera.y = std::max(-half.y, std::min(camera.y, pitch.y * rows - half.y));
+}
+
 void Grid::clearWalls() {
-    for(int j = 0; j < rows; ++j) {
-        for(int i = 0; i < columns; ++i) {
-            nodes[i][j]->setWall(false);
-            updateHeuristics();
-        }
+    unsigned int target = pause();
+    map.clearWalls();
+    catchUp(target);
+}
+
+bool Grid::save(const std::string& path) {
+    return MapFile::save(path, map);
+}
+
+// Only maps of the grid's size can be shown
+bool Grid::load(const std::string& path) {
+    MapFile file;
+
+    if(!file.open(path) || file.rows() != rows || file.columns() != columns) {
+        return false;
     }
+
+    unsigned int target = pause();
+    bool loaded = file.load(map);
+    start.setNode(map.start, position(map.start));
+    goal.setNode(map.goal, position(map.goal));
+    catchUp(target);
+    return loaded;
 }
 
-void Grid::updateHeuristics() {
+void Grid::setAlgorithm(PFAlgorithm* algorithm) {
+    worker.cancel();
+    algorithm->trace.recording = true;
+    map.algorithm = algorithm;
+    
+    unsigned int target = pause();
+    map.updateHeuristics();
+    catchUp(target);
+}
+
+// Stops the worker and rewinds the search, so the replan an edit causes
+// doesn't run it on this thread. Returns the iteration the view was at.
+unsigned int Grid::pause() {
+    worker.cancel();
+    
+    if(map.algorithm == nullptr) {
+        return 0;
+    }
+    
+    unsigned int target = map.algorithm->iteration;
+    map.algorithm->iteration = 0;
+    return target;
+}
+
+// Shows the replanned search, then has the worker run it on to target
+void Grid::catchUp(unsigned int target) {
+    updateNodes();
+    
+    if(map.algorithm != nullptr) {
+        worker.start(map.algorithm, target, 0);
+    }
+}
+
+void Grid::iterate() {
+    worker.cancel();
+    map.algorithm->iterate();
+    updateNodes();
+}
+
+void Grid::rewind() {
+    worker.cancel();
+    map.algorithm->rewind();
+    updateNodes();
+}
+
+void Grid::toStart() {
+    worker.cancel();
+    map.algorithm->toStart();
+    updateNodes();
+}
+
+void Grid::toEnd() {
+    worker.start(map.algorithm, Map::infinity, rate);
+}
+
+void Grid::setRate(unsigned int rate) {
+    this->rate = rate;
+    worker.setRate(rate);
+}
+
+void Grid::update() {
+    if(!worker.running()) {
+        return;
+    }
+    
+    if(worker.finished()) {
+        worker.cancel();
+        updateNodes();
+    } else if(worker.poll()) {
+        setColors(worker.snapshot());
+        ++version;
+    }
+}
+
+// Mirrors the walls and the search state at the current iteration into the
+// cells
+void Grid::updateNodes() {
+    PFAlgorithm* algorithm = map.algorithm;
+    
     for(int j = 0; j < rows; ++j) {
         for(int i = 0; i < columns; ++i) {
-            Node* node = nodes[i][j];
-            node->neighbours.clear();
-            
-            if(i >= 1) {
-                node->link(nodes[i - 1][j]);
-            }
+            unsigned int index = map.index(i, j);
             
-            if(j >= 1) {
-                node->link(nodes[i][j - 1]);
+            if(map.wall(index)) {
+                setColor(index, wallColor);
+            } else if(algorithm != nullptr &&
+                      (index == algorithm->trace.current() || algorithm->trace.isClosed(index)))
+            {
+                setColor(index, openBlue);
+            } else if(algorithm != nullptr && algorithm->trace.isOpen(index)) {
+                setColor(index, visitedBlue);
+            } else {
+                setColor(index, gridBg);
             }
-            
-            // Diagonals
-            
-            if(i >= 1 && j >= 1) {
-                node->link(nodes[i - 1][j - 1]);
-            }
-            
-            if(i + 1 < columns && j >= 1) {
-                node->link(nodes[i + 1][j - 1]);
-            }
-            
-            
-            nodes[i][j]->fCost = 1000;
-            nodes[i][j]->gCost = 1000;
-            
-            nodes[i][j]->cameFrom = nullptr;
-            if(!nodes[i][j]->getWall()) {
-                nodes[i][j]->rect.setFillColor(gridBg);
-            }
-            // Manhattan distance
-            nodes[i][j]->heuristic = abs(i - goal.node->i) + abs(j - goal.node->j);
-            nodes[i][j]->heuristicLabel.setString(std::to_string(nodes[i][j]->heuristic));
-            nodes[i][j]->gCostLabel.setString("");
-            nodes[i][j]->fCostLabel.setString("");
         }
     }
     
-    start.node->gCost = 0;
-    
-    if(algorithm != nullptr) {
-        algorithm->reset();
-        algorithm->run();
-    }
+    ++version;
 }
 
-unsigned int Grid::movCost(Node* n1, Node* n2) {
-    return abs(n1->i - n2->i) + abs(n1->j - n2->j) > 1 ? 14 : 10;
+void Grid::setColors(const SearchWorker::Snapshot& snapshot) {
+    for(unsigned int index = 0; index < map.size(); ++index) {
+        if(map.wall(index)) {
+            setColor(index, wallColor);
+        } else if(index == snapshot.current || snapshot.cells[index] == SearchWorker::closed) {
+            setColor(index, openBlue);
+        } else if(snapshot.cells[index] == SearchWorker::open) {
+            setColor(index, visitedBlue);
+        } else {
+            setColor(index, gridBg);
+        }
+    }
 }
 
-bool Grid::getWall(unsigned int i, unsigned int j) {
-    return nodes[i][j]->getWall();
+unsigned int Grid::vertex(unsigned int i, unsigned int j) const {
+    unsigned int first = ((j / chunk) * chunkColumns + i / chunk) * chunk * chunk;
+    return (first + (j % chunk) * chunk + i % chunk) * 4;
 }
 
-void Grid::setWall(unsigned int i, unsigned int j, bool wall) {
-    nodes[i][j]->setWall(wall);
-    updateHeuristics();
+void Grid::setColor(unsigned int index, sf::Color color) {
+    sf::Vertex* quad = &cells[vertex(map.column(index), map.row(index))];
+    
+    if(quad[0].color != color) {
+        for(unsigned int v = 0; v < 4; ++v) {
+            quad[v].color = color;
+        }
+    }
 }
 
-void Grid::draw(sf::RenderTarget& target, sf::RenderStates states) const {
-    states.transform *= getTransform();
-    target.draw(borderRect, states);
+// Blocks of factor x factor cells become one quad of their mean colour
+void Grid::updateMerged(sf::IntRect area, unsigned int factor) const {
+    if(factor == mergedFactor && version == mergedVersion && area == mergedArea) {
+        return;
+    }
+    
+    mergedFactor = factor;
+    mergedVersion = version;
+    mergedArea = area;
+    merged.clear();
+    
+    unsigned int firstRow = area.top / factor * factor;
+    unsigned int firstColumn = area.left / factor * factor;
     
-    for(int i = 0; i < columns; ++i) {
-        for(int j = 0; j < rows; ++j) {
-            target.draw(*nodes[i][j], states);
+    for(unsigned int j0 = firstRow; j0 < (unsigned int) (area.top + area.height); j0 += factor) {
+        for(unsigned int i0 = firstColumn; i0 < (unsigned int) (area.left + area.width); i0 += factor) {
+            unsigned int i1 = std::min(i0 + factor, columns);
+            unsigned int j1 = std::min(j0 + factor, rows);
+            unsigned int r = 0, g = 0, b = 0;
+            
+            for(unsigned int j = j0; j < j1; ++j) {
+                for(unsigned int i = i0; i < i1; ++i) {
+                    const sf::Color& color = cells[vertex(i, j)].color;
+                    r += color.r;
+                    g += color.g;
+                    b += color.b;
+                }
+            }
+            
+            unsigned int count = (i1 - i0) * (j1 - j0);
+            sf::Color color(r / count, g / count, b / count);
+            sf::Vector2f topLeft(pitch.x * i0 + 1, pitch.y * j0 + 1);
+            sf::Vector2f bottomRight(pitch.x * i1, pitch.y * j1);
+            
+            merged.append(sf::Vertex(topLeft, color));
+            merged.append(sf::Vertex(sf::Vector2f(bottomRight.x, topLeft.y), color));
+            merged.append(sf::Vertex(bottomRight, color));
+            merged.append(sf::Vertex(sf::Vector2f(topLeft.x, bottomRight.y), color));
         }
     }
-    
-    target.draw(start.rect, states);
-    target.draw(goal.rect, states);
 }
+
+void Grid::updateLabels(sf::IntRect area) const {
+    if(version == labelVersion && area == labelArea) {
+        return;
+    }
     
-void AStar::run(bool toEnd) {
-    openSet.insert(grid.start.node);
+    labelVersion = version;
+    labelArea = area;
+    labels.resize(area.width * area.height * 3 * slots * 4);
     
-    while(!openSet.empty() && (iterations < iteration || toEnd)) {
-        unsigned int min = 1000;
-        
-        Node* current = *(openSet.begin());
-        
-        std::set<Node*>::iterator iterator;
-        for(iterator = openSet.begin(); iterator != openSet.end(); ++iterator) {
-            if((*iterator)->fCost < min) {
-                current = *(iterator);
-                min = current->fCost;
+    PFAlgorithm* algorithm = map.algorithm;
+    unsigned int label = 0;
+    
+    for(int j = area.top; j < area.top + area.height; ++j) {
+        for(int i = area.left; i < area.left + area.width; ++i) {
+            unsigned int index = map.index(i, j);
+            unsigned int h = DigitAtlas::blank;
+            unsigned int g = DigitAtlas::blank;
+            unsigned int f = DigitAtlas::blank;
+            
+            if(algorithm != nullptr) {
+                h = algorithm->heuristic(index);
             }
-        }
-        
-        current->rect.setFillColor(openBlue);
-        
-        if(current == grid.goal.node) {
-            break;
-        }
-        
-        openSet.erase(current);
-        closedSet.insert(current);
-        
-        unsigned int newCost = 1000;
-        
-        for(Node* neighbour : current->neighbours) {
-            if(closedSet.find(neighbour) == closedSet.end()) {
-                neighbour->rect.setFillColor(visitedBlue);
-                
-                openSet.insert(neighbour);
-                newCost = current->gCost + grid.movCost(current, neighbour);
-                
-                //neighbour->fCostLabel.setString(std::to_string(newCost));
-                if(newCost < neighbour->gCost) {
-                    neighbour->gCost = newCost;
-                    neighbour->gCostLabel.setString(std::to_string(neighbour->gCost));
-                    
-                    neighbour->fCost = newCost + neighbour->heuristic;
-                    neighbour->fCostLabel.setString(std::to_string(neighbour->fCost));
-                    neighbour->cameFrom = current;
-                }
-                
+            
+            if(algorithm != nullptr &&
+               algorithm->trace.cameFrom(index) != Map::none &&
+               algorithm->trace.gCost(index) != Map::infinity)
+            {
+                g = algorithm->trace.gCost(index);
+                f = algorithm->trace.fCost(index);
             }
+            
+            sf::Vector2f topLeft = position(index);
+            digits.write(&labels[label++ * slots * 4], slots, h, topLeft, dark);
+            digits.write(&labels[label++ * slots * 4], slots, g, topLeft + sf::Vector2f(0, 10), dark);
+            digits.write(&labels[label++ * slots * 4], slots, f, topLeft + sf::Vector2f(0, 20), dark);
         }
-        
-        ++iterations;
     }
+}
+
+bool Grid::getWall(unsigned int i, unsigned int j) {
+    return map.getWall(i, j);
+}
+
+void Grid::setWall(unsigned int i, unsigned int j, bool wall) {
+    unsigned int target = pause();
+    map.setWall(i, j, wall);
+    catchUp(target);
+}
+
+void Grid::setRef(NodeRef* ref, unsigned int i, unsigned int j) {
+    unsigned int target = pause();
+    ref->setNode(map.index(i, j), position(map.index(i, j)));
     
-    if(toEnd) {
-        iteration = iterations;
+    if(ref == &start) {
+        map.setStart(i, j);
+    } else {
+        map.setGoal(i, j);
     }
+    
+    catchUp(target);
 }
 
-void Greedy::run(bool toEnd) {
-    openSet.insert(grid.start.node);
+// Drawn through the camera's view. Chunks in a row of chunks are contiguous,
+// so each visible row of them is one draw call.
+void Grid::draw(sf::RenderTarget& target, sf::RenderStates states) const {
+    sf::RenderStates border = states;
+    border.transform *= getTransform();
+    target.draw(borderRect, border);
     
-    while(!openSet.empty() && (iterations < iteration || toEnd)) {
-        unsigned int min = 1000;
-        
-        Node* current = *(openSet.begin());
-        
-        std::set<Node*>::iterator iterator;
-        for(iterator = openSet.begin(); iterator != openSet.end(); ++iterator) {
-            if((*iterator)->heuristic < min) {
-                current = *(iterator);
-                min = current->heuristic;
-            }
-            
-        }
-        
-        current->rect.setFillColor(openBlue);
+    sf::View previous = target.getView();
+    target.setView(view(target));
+    
+    sf::IntRect area = visibleCells();
+    float size = std::min(pitch.x, pitch.y) * zoom;
+    
+    if(area.width > 0 && area.height > 0 && size >= 2) {
+        unsigned int firstColumn = area.left / chunk;
+        unsigned int lastColumn = (area.left + area.width - 1) / chunk;
+        unsigned int quads = chunk * chunk * 4;
         
-        if(current == grid.goal.node) {
-            break;
+        for(unsigned int row = area.top / chunk; row <= (area.top + area.height - 1) / chunk; ++row) {
+            unsigned int first = (row * chunkColumns + firstColumn) * quads;
+            target.draw(&cells[first], (lastColumn - firstColumn + 1) * quads, sf::Quads, states);
         }
+    } else if(area.width > 0 && area.height > 0) {
+        unsigned int factor = 2;
         
-        openSet.erase(current);
-        closedSet.insert(current);
-        
-        min = 1000;
-        
-        for(Node* neighbour : current->neighbours) {
-            if(closedSet.find(neighbour) == closedSet.end()) {
-                neighbour->rect.setFillColor(visitedBlue);
-
-                if(neighbour->heuristic < min && neighbour->cameFrom == nullptr) {
-                    neighbour->cameFrom = current;
-                }
-                
-                openSet.insert(neighbour);
-            }
+        while(factor * size < 2) {
+            factor *= 2;
         }
         
-        ++iterations;
+        updateMerged(area, factor);
+        target.draw(merged, states);
     }
     
-    if(toEnd) {
-        iteration = iterations;
+    // Three lines of 10 pixels, once the worker has let go of the search
+    if(area.width > 0 && area.height > 0 && (pitch.y - 1) * zoom >= 30 && !worker.running()) {
+        updateLabels(area);
+        sf::RenderStates text = states;
+        text.texture = &digits.texture();
+        target.draw(labels, text);
     }
+    
+    target.draw(start.rect, states);
+    target.draw(goal.rect, states);
+    target.setView(previous);
 }
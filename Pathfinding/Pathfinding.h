@@ -2,122 +2,156 @@
 #define __Pathfinding__Pathfinding__
 
 #include <SFML/Graphics.hpp>
-#include <list>
-#include <set>
+#include <string>
+#include <vector>
+#include "Map.h"
+#include "Search.h"
+#include "SearchWorker.h"
 
-class Node : public sf::Drawable {
+// The glyphs of 0-9 at one size, which all sit on the font's texture for that
+// size, so any number of labels can be drawn as quads in one call
+class DigitAtlas {
 public:
-    Node(unsigned int width, unsigned int height, sf::Transformable* parent, const sf::Font& font);
+    static const unsigned int blank = 0xFFFFFFFF;
     
-    bool getWall();
-    void setWall(bool wall);
-    sf::Vector2f center();
-    bool contains(sf::Vector2i point);
-    void link(Node* node);
+    DigitAtlas(const sf::Font& font, unsigned int size);
     
-    sf::RectangleShape rect;
-    sf::Text heuristicLabel;
-    sf::Text gCostLabel;
-    sf::Text fCostLabel;
-    std::list<Node*> neighbours;
-    Node* cameFrom;
-    unsigned int i;
-    unsigned int j;
-    unsigned int heuristic;
-    unsigned int gCost;
-    unsigned int fCost;
-private:
-    sf::Transformable* parent;
-    bool wall;
+    const sf::Texture& texture() const;
     
-    virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const;
+    // Writes a number into slots quads, leaving the unused ones empty. Longer
+    // numbers are cut to their leading digits; blank writes nothing.
+    void write(sf::Vertex* quads, unsigned int slots, unsigned int value, sf::Vector2f position, sf::Color color) const;
+    
+private:
+    const sf::Font& font;
+    unsigned int size;
+    sf::Glyph glyphs[10];
 };
 
+// The start or goal marker. Positions are in grid coordinates.
 class NodeRef : public sf::Drawable {
 public:
-    NodeRef() : node(nullptr) {};
-    NodeRef(Node* node, sf::Color color, sf::Transformable* parent);
+    NodeRef() : index(Map::none), dragging(false) {};
+    NodeRef(unsigned int index, sf::Vector2f position, sf::Vector2f size, sf::Color color);
     
-    bool contains(sf::Vector2i point);
-    void moveToMousePosition(sf::Vector2f mousePos);
+    bool contains(sf::Vector2f point);
+    void moveToMousePosition(sf::Vector2f point);
     void moveToNode();
-    void setNode(Node* node);
+    void setNode(unsigned int index, sf::Vector2f position);
     
-    Node* node;
+    unsigned int index;
     sf::RectangleShape rect;
 
 private:
-    sf::Transformable* parent;
+    sf::Vector2f home;
     bool dragging;
     sf::Vector2f dragOffset;
     
     virtual void  draw(sf::RenderTarget& target, sf::RenderStates states) const;
 };
 
-class Grid;
-
-class PFAlgorithm {
-public:
-    PFAlgorithm(Grid& grid)
-    : grid(grid),
-    iteration(0),
-    iterations(0)
-    {}
-    
-    void iterate();
-    void rewind();
-    void reset();
-    void toStart();
-    void toEnd();
-    virtual void run(bool toEnd = false) = 0;
-    
-    std::set<Node*> openSet;
-    std::set<Node*> closedSet;
-    Grid& grid;
-    unsigned int iterations;
-    unsigned int iteration;
-};
-
+// Shows the map through a camera that pans and zooms inside a width x height
+// area. Cells are pitch apart in grid coordinates, so the cell under a point
+// is found arithmetically.
+//
+// Searches run on a worker and the grid shows its snapshots. Every edit stops
+// the worker first, and then has it catch up to where the view was.
+//
+// Cells are drawn a chunk row at a time, only where visible. Once cells get
+// under two pixels, blocks of them are merged into one quad of their mean
+// colour, and labels are only drawn while they fit.
 class Grid : public sf::Transformable, public sf::Drawable {
 public:
     Grid(unsigned int rows, unsigned int columns, unsigned int width, unsigned int height, const sf::Font& font);
     
-    Node* nodes[20][20];
+    Map map;
     NodeRef start;
     NodeRef goal;
-    PFAlgorithm* algorithm;
     
     unsigned int rows;
     unsigned int columns;
     unsigned int width;
     unsigned int height;
+    sf::Vector2f pitch;
+    
+    // The grid point at the top left of the area and screen pixels per unit
+    sf::Vector2f camera;
+    float zoom;
     
     sf::RectangleShape borderRect;
     
-    unsigned int movCost(Node* n1, Node* n2);
+    sf::Vector2f toGrid(sf::Vector2i point) const;
+    bool cellAt(sf::Vector2i point, unsigned int& i, unsigned int& j) const;
+    sf::Vector2f position(unsigned int index) const;
+    sf::Vector2f center(unsigned int index) const;
+    
+    // Cells [left, left + width) x [top, top + height) are in view
+    sf::IntRect visibleCells() const;
+    
+    // Draws grid coordinates into the area, clipped to it
+    sf::View view(const sf::RenderTarget& target) const;
+    
+    void pan(sf::Vector2f offset);
+    void zoomAt(sf::Vector2i point, float factor);
+    
     bool getWall(unsigned int i, unsigned int j);
     void setWall(unsigned int i, unsigned int j, bool wall);
-    void movCost();
+    void setRef(NodeRef* ref, unsigned int i, unsigned int j);
+    void setAlgorithm(PFAlgorithm* algorithm);
     bool contains(sf::Vector2i point);
     void clearWalls();
-    void updateHeuristics();
+    bool save(const std::string& path);
+    bool load(const std::string& path);
+    void updateNodes();
+    
+    // Stepping stops the worker. toEnd plays the search on it at rate
+    // iterations a second, 0 being as fast as it goes.
+    void iterate();
+    void rewind();
+    void toStart();
+    void toEnd();
+    void setRate(unsigned int rate);
+    
+    // While searching, nothing but the grid may read the algorithm
+    bool searching() const { return worker.running(); }
+    
+    // Shows the worker's progress; called every frame
+    void update();
     
 private:
-    virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const;
-};
-
-class AStar : public PFAlgorithm {
-public:
-    AStar(Grid& grid) : PFAlgorithm(grid) {}
+    // Digits per label and cells per chunk side
+    static const unsigned int slots = 7;
+    static const unsigned int chunk = 32;
     
-    virtual void run(bool toEnd);
-};
-
-class Greedy : public PFAlgorithm {
-public:
-    Greedy(Grid& grid) : PFAlgorithm(grid) {}
+    unsigned int pause();
+    void catchUp(unsigned int target);
+    void setColors(const SearchWorker::Snapshot& snapshot);
+    unsigned int vertex(unsigned int i, unsigned int j) const;
+    float fittingZoom() const;
+    void clampCamera();
+    void setColor(unsigned int index, sf::Color color);
+    void updateMerged(sf::IntRect area, unsigned int factor) const;
+    void updateLabels(sf::IntRect area) const;
+    
+    // One quad per cell, chunk by chunk, written in place when a cell's
+    // colour changes. The merged quads and labels cover the view and are
+    // rebuilt when it moves or version changes.
+    sf::VertexArray cells;
+    mutable sf::VertexArray merged;
+    mutable sf::VertexArray labels;
+    mutable sf::IntRect mergedArea;
+    mutable sf::IntRect labelArea;
+    mutable unsigned int mergedFactor;
+    mutable unsigned int mergedVersion;
+    mutable unsigned int labelVersion;
+    unsigned int version;
+    unsigned int chunkColumns;
+    DigitAtlas digits;
     
-    virtual void run(bool toEnd);
+    SearchWorker worker;
+    unsigned int rate;
+    
+    virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const;
 };
 
 #endif /* defined(__Pathfinding__Pathfinding__) */
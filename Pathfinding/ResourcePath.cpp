@@ -0,0 +1,11 @@
+#include "ResourcePath.hpp"
+
+// Outside macOS there is no bundle; the build says where resources are
+std::string resourcePath(void)
+{
+#ifdef PATHFINDING_RESOURCE_DIR
+    return PATHFINDING_RESOURCE_DIR "/";
+#else
+    return "";
+#endif
+}
@@ -0,0 +1,202 @@
+#include "Search.h"
+#include <algorithm>
+
+void PFAlgorithm::iterate() {
+    ++iteration;
+
+    if(trace.recording) {
+        run();
+        iteration = std::min(iteration, iterations);
+    }
+
+    seek();
+}
+
+void PFAlgorithm::rewind() {
+    if(iteration >= 1)
+        iteration -= 1;
+
+    seek();
+}
+
+void PFAlgorithm::reset() {
+    unsigned int nodes = map.size();
+
+    if(search.size() != nodes) {
+        openList.resize(nodes);
+    } else {
+        openList.clear();
+    }
+
+    search.clear(nodes);
+    trace.clear(nodes);
+    map.updateComponents();
+    current = Map::none;
+
+    iterations = 0;
+}
+
+void PFAlgorithm::toStart() {
+    iteration = 0;
+
+    seek();
+}
+
+void PFAlgorithm::toEnd() {
+    if(trace.recording) {
+        run(true);
+    } else {
+        iteration = Map::infinity;
+    }
+
+    seek();
+    iteration = iterations;
+}
+
+void PFAlgorithm::replan() {
+    map.updateHeuristics();
+}
+
+// Follows cameFrom back from the goal. Returns the cells from start to goal,
+// or nothing if the goal hasn't been reached.
+std::vector<unsigned int> PFAlgorithm::path() {
+    std::vector<unsigned int> cells;
+    unsigned int node = map.goal;
+
+    while(node != map.start) {
+        if(node == Map::none) {
+            return std::vector<unsigned int>();
+        }
+
+        cells.push_back(node);
+        node = search.cameFrom(node);
+    }
+
+    cells.push_back(map.start);
+    std::reverse(cells.begin(), cells.end());
+    return cells;
+}
+
+unsigned int PFAlgorithm::heuristic(unsigned int node) const {
+    return estimate<Octile>(map, node, map.goal);
+}
+
+void PFAlgorithm::wallChanged(unsigned int) {
+    replan();
+}
+
+void PFAlgorithm::wallsChanged(unsigned int, unsigned int, unsigned int, unsigned int) {
+    replan();
+}
+
+void PFAlgorithm::startChanged() {
+    replan();
+}
+
+void PFAlgorithm::goalChanged() {
+    replan();
+}
+
+void PFAlgorithm::costsChanged(unsigned int, unsigned int, unsigned int, unsigned int) {
+    replan();
+}
+
+void PFAlgorithm::open(unsigned int node, uint64_t key) {
+    Trace::Type type = openList.contains(node) ? Trace::relaxed : Trace::opened;
+    openList.push(node, key);
+    record(type, node);
+}
+
+void PFAlgorithm::close(unsigned int node) {
+    search.touch(node).closed = true;
+    trace.step(node);
+    record(Trace::closed, node);
+}
+
+void PFAlgorithm::record(Trace::Type type, unsigned int node) {
+    trace.record(type, node, search.cameFrom(node), search.gCost(node), search.fCost(node));
+}
+
+// Without a trace every step searches again up to the iteration
+void PFAlgorithm::seek() {
+    if(trace.recording) {
+        trace.seek(iteration);
+    } else {
+        map.updateHeuristics();
+    }
+}
+
+// Open list keys put the f cost in the high word so ties go to the node
+// closest to the goal
+static uint64_t openKey(unsigned int cost, unsigned int tieBreak) {
+    return ((uint64_t) cost << 32) | tieBreak;
+}
+
+template<typename Heuristic>
+void BasicAStar<Heuristic>::reset() {
+    PFAlgorithm::reset();
+    start([this](unsigned int node) { return estimate<Heuristic>(map, node, map.goal); });
+}
+
+template<typename Heuristic>
+void BasicAStar<Heuristic>::run(bool toEnd) {
+    expand(toEnd, [this](unsigned int node) { return estimate<Heuristic>(map, node, map.goal); });
+}
+
+template<typename Heuristic>
+unsigned int BasicAStar<Heuristic>::heuristic(unsigned int node) const {
+    return estimate<Heuristic>(map, node, map.goal);
+}
+
+template<typename Heuristic>
+void BasicGreedy<Heuristic>::reset() {
+    PFAlgorithm::reset();
+
+    if(!map.connected(map.start, map.goal)) {
+        return;
+    }
+
+    search.touch(map.start).gCost = 0;
+    open(map.start, openKey(heuristic(map.start), 0));
+}
+
+template<typename Heuristic>
+void BasicGreedy<Heuristic>::run(bool toEnd) {
+    while(!openList.empty() && (iterations < iteration || toEnd)) {
+        current = openList.top();
+
+        if(current == map.goal) {
+            break;
+        }
+
+        openList.pop();
+        close(current);
+
+        map.forEachNeighbour(current, [this](unsigned int neighbour, unsigned int) {
+            if(!search.closed(neighbour) && !openList.contains(neighbour)) {
+                search.touch(neighbour).cameFrom = current;
+                open(neighbour, openKey(estimate<Heuristic>(map, neighbour, map.goal), 0));
+            }
+        });
+
+        ++iterations;
+    }
+
+    if(toEnd) {
+        iteration = iterations;
+    }
+}
+
+template<typename Heuristic>
+unsigned int BasicGreedy<Heuristic>::heuristic(unsigned int node) const {
+    return estimate<Heuristic>(map, node, map.goal);
+}
+
+template class BasicAStar<Octile>;
+template class BasicAStar<Chebyshev>;
+template class BasicAStar<Euclidean>;
+template class BasicAStar<Manhattan>;
+template class BasicGreedy<Octile>;
+template class BasicGreedy<Chebyshev>;
+template class BasicGreedy<Euclidean>;
+template class BasicGreedy<Manhattan>;
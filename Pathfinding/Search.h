@@ -0,0 +1,148 @@
+#ifndef __Pathfinding__Search__
+#define __Pathfinding__Search__
+
+#include "Heuristic.h"
+#include "Map.h"
+#include "OpenList.h"
+#include "Trace.h"
+#include "Workspace.h"
+#include <vector>
+
+class PFAlgorithm {
+public:
+    PFAlgorithm(Map& map)
+    : map(map),
+    current(Map::none),
+    iterations(0),
+    iteration(0)
+    {}
+    virtual ~PFAlgorithm() {}
+
+    // When recording, stepping moves the trace view and only steps past the
+    // furthest iteration reached resume the search
+    void iterate();
+    void rewind();
+    void toStart();
+    void toEnd();
+    void replan();
+    virtual void reset();
+    virtual void run(bool toEnd = false) = 0;
+    virtual std::vector<unsigned int> path();
+
+    // Estimated cost from a cell to the goal. Searches call their heuristic
+    // directly; this is for showing it.
+    virtual unsigned int heuristic(unsigned int node) const;
+
+    // Called by the map after an edit. The default replans from scratch.
+    // wallsChanged gets the rectangle [i0, i1) x [j0, j1) of a batch, and
+    // costsChanged's rectangle also covers walls changed in the same batch.
+    virtual void wallChanged(unsigned int node);
+    virtual void wallsChanged(unsigned int i0, unsigned int j0, unsigned int i1, unsigned int j1);
+    virtual void startChanged();
+    virtual void goalChanged();
+    virtual void costsChanged(unsigned int i0, unsigned int j0, unsigned int i1, unsigned int j1);
+
+    OpenList openList;
+    Workspace search;
+    Trace trace;
+    Map& map;
+    unsigned int current;
+    unsigned int iterations;
+    unsigned int iteration;
+
+protected:
+    // Queue and close nodes, logging the change to the trace
+    void open(unsigned int node, uint64_t key);
+    void close(unsigned int node);
+    void record(Trace::Type type, unsigned int node);
+
+private:
+    void seek();
+};
+
+// The heuristic is a policy from Heuristic.h. Searches that only change the
+// estimate derive from it and pass their own to start and expand, which
+// call it inline.
+template<typename Heuristic>
+class BasicAStar : public PFAlgorithm {
+public:
+    BasicAStar(Map& map) : PFAlgorithm(map) {}
+
+    virtual void reset();
+    virtual void run(bool toEnd);
+    virtual unsigned int heuristic(unsigned int node) const;
+
+protected:
+    template<typename Estimate>
+    void start(Estimate estimate);
+
+    template<typename Estimate>
+    void expand(bool toEnd, Estimate estimate);
+};
+
+template<typename Heuristic>
+class BasicGreedy : public PFAlgorithm {
+public:
+    BasicGreedy(Map& map) : PFAlgorithm(map) {}
+
+    virtual void reset();
+    virtual void run(bool toEnd);
+    virtual unsigned int heuristic(unsigned int node) const;
+};
+
+typedef BasicAStar<Octile> AStar;
+typedef BasicGreedy<Octile> Greedy;
+
+// Open list keys put the f cost in the high word so ties go to the node
+// closest to the goal
+template<typename Heuristic>
+template<typename Estimate>
+void BasicAStar<Heuristic>::start(Estimate estimate) {
+    if(!map.connected(map.start, map.goal)) {
+        return;
+    }
+
+    unsigned int h = estimate(map.start);
+    Workspace::Cell& cell = search.touch(map.start);
+    cell.gCost = 0;
+    cell.fCost = h;
+    open(map.start, ((uint64_t) h << 32) | h);
+}
+
+template<typename Heuristic>
+template<typename Estimate>
+void BasicAStar<Heuristic>::expand(bool toEnd, Estimate estimate) {
+    while(!openList.empty() && (iterations < iteration || toEnd)) {
+        current = openList.top();
+
+        if(current == map.goal) {
+            break;
+        }
+
+        openList.pop();
+        close(current);
+
+        map.forEachNeighbour(current, [&](unsigned int neighbour, unsigned int cost) {
+            if(!search.closed(neighbour)) {
+                unsigned int newCost = search.gCost(current) + cost;
+
+                if(newCost < search.gCost(neighbour)) {
+                    unsigned int h = estimate(neighbour);
+                    Workspace::Cell& cell = search.touch(neighbour);
+                    cell.gCost = newCost;
+                    cell.fCost = newCost + h;
+                    cell.cameFrom = current;
+                    open(neighbour, ((uint64_t) cell.fCost << 32) | h);
+                }
+            }
+        });
+
+        ++iterations;
+    }
+
+    if(toEnd) {
+        iteration = iterations;
+    }
+}
+
+#endif /* defined(__Pathfinding__Search__) */
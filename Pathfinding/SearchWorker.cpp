@@ -0,0 +1,120 @@
+#include "SearchWorker.h"
+#include <algorithm>
+#include <chrono>
+
+typedef std::chrono::steady_clock Clock;
+
+// Iterations between checks for cancellation and time to publish
+static const unsigned int chunk = 256;
+static const std::chrono::milliseconds publishEvery(16);
+
+SearchWorker::SearchWorker()
+: algorithm(nullptr),
+  target(0),
+  rate(0),
+  cancelled(false),
+  done(false),
+  middle(1),
+  back(0),
+  front(2)
+{}
+
+SearchWorker::~SearchWorker() {
+    cancel();
+}
+
+void SearchWorker::start(PFAlgorithm* algorithm, unsigned int target, unsigned int rate) {
+    cancel();
+
+    this->algorithm = algorithm;
+    this->target = target;
+    this->rate = rate;
+    cancelled = false;
+    done = false;
+    thread = std::thread(&SearchWorker::work, this);
+}
+
+void SearchWorker::cancel() {
+    if(thread.joinable()) {
+        cancelled = true;
+        thread.join();
+    }
+}
+
+bool SearchWorker::poll() {
+    if(!(middle.load() & fresh)) {
+        return false;
+    }
+
+    front = middle.exchange(front) & 3;
+    return true;
+}
+
+// Iterations are allowed as time passes; a change of rate applies from then on
+void SearchWorker::work() {
+    Clock::time_point last = Clock::now();
+    Clock::time_point published = last;
+    double allowed = algorithm->iteration;
+
+    algorithm->trace.seek(algorithm->iteration);
+
+    while(!cancelled) {
+        Clock::time_point now = Clock::now();
+        unsigned int limit = target;
+
+        if(rate != 0) {
+            allowed += std::chrono::duration<double>(now - last).count() * rate;
+            limit = (unsigned int) std::min<double>(allowed, target);
+        }
+
+        last = now;
+
+        if(limit <= algorithm->iteration) {
+            if(algorithm->iteration >= target) {
+                break;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+
+        unsigned int next = std::min(limit, algorithm->iteration + chunk);
+        algorithm->iteration = next;
+        algorithm->run(false);
+
+        // Stopping short means the search is over
+        if(algorithm->iterations < next) {
+            algorithm->iteration = algorithm->iterations;
+            target = algorithm->iteration;
+        }
+
+        algorithm->trace.seek(algorithm->iteration);
+
+        if(now - published >= publishEvery) {
+            publish(false);
+            published = now;
+        }
+    }
+
+    if(!cancelled) {
+        publish(true);
+        done = true;
+    }
+}
+
+void SearchWorker::publish(bool finished) {
+    Snapshot& snapshot = buffers[back];
+    const Trace& trace = algorithm->trace;
+    unsigned int nodes = algorithm->map.size();
+
+    snapshot.cells.resize(nodes);
+
+    for(unsigned int node = 0; node < nodes; ++node) {
+        snapshot.cells[node] = trace.isClosed(node) ? closed : (trace.isOpen(node) ? open : unseen);
+    }
+
+    snapshot.current = trace.current();
+    snapshot.iteration = algorithm->iteration;
+    snapshot.finished = finished;
+    back = middle.exchange(back | fresh) & 3;
+}
@@ -0,0 +1,66 @@
+#ifndef __Pathfinding__SearchWorker__
+#define __Pathfinding__SearchWorker__
+
+#include "Search.h"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// Steps a recording search on its own thread, at most rate iterations a
+// second, and publishes what the trace shows through a lock-free triple
+// buffer: the worker fills its own snapshot and swaps it with the spare one,
+// the reader swaps the spare with its own when a fresh one is there. Neither
+// side ever waits and the reader's snapshot is never written under it.
+//
+// Nothing else may touch the algorithm or edit the map while it runs.
+// cancel() is cooperative: the worker checks between chunks of iterations.
+class SearchWorker {
+public:
+    enum State : uint8_t { unseen, open, closed };
+
+    struct Snapshot {
+        std::vector<uint8_t> cells;
+        unsigned int current;
+        unsigned int iteration;
+        bool finished;
+    };
+
+    SearchWorker();
+    ~SearchWorker();
+
+    // Carries the search on from its current iteration up to target, or to
+    // its end with Map::infinity. A rate of 0 doesn't hold it back.
+    void start(PFAlgorithm* algorithm, unsigned int target, unsigned int rate);
+    void cancel();
+    void setRate(unsigned int rate) { this->rate = rate; }
+
+    // Until cancelled, even once finished
+    bool running() const { return thread.joinable(); }
+    bool finished() const { return done; }
+
+    // Takes the latest snapshot if a newer one was published. The snapshot
+    // stays the same until the next call.
+    bool poll();
+    const Snapshot& snapshot() const { return buffers[front]; }
+
+private:
+    static const unsigned int fresh = 4;
+
+    void work();
+    void publish(bool finished);
+
+    PFAlgorithm* algorithm;
+    unsigned int target;
+    std::atomic<unsigned int> rate;
+    std::atomic<bool> cancelled;
+    std::atomic<bool> done;
+    std::thread thread;
+
+    Snapshot buffers[3];
+    std::atomic<unsigned int> middle;
+    unsigned int back;
+    unsigned int front;
+};
+
+#endif /* defined(__Pathfinding__SearchWorker__) */
@@ -0,0 +1,96 @@
+#include "ThetaStar.h"
+#include "LineOfSight.h"
+
+void ThetaStar::reset() {
+    PFAlgorithm::reset();
+
+    if(!map.connected(map.start, map.goal)) {
+        return;
+    }
+
+    unsigned int h = heuristic(map.start);
+    Workspace::Cell& start = search.touch(map.start);
+    start.gCost = 0;
+    start.fCost = h;
+    open(map.start, ((uint64_t) h << 32) | h);
+}
+
+// Closes the goal too, so its parent is checked in the lazy variant
+void ThetaStar::run(bool toEnd) {
+    while(!openList.empty() && !search.closed(map.goal) && (iterations < iteration || toEnd)) {
+        current = openList.pop();
+
+        if(lazy) {
+            setParent(current);
+        }
+
+        close(current);
+
+        if(current != map.goal) {
+            unsigned int parent = search.cameFrom(current);
+            bool straight = parent != Map::none && !map.weighted();
+
+            map.forEachNeighbour(current, [&](unsigned int neighbour, unsigned int cost) {
+                if(search.closed(neighbour)) {
+                    return;
+                }
+
+                if(straight && (lazy || lineOfSight(map, parent, neighbour))) {
+                    relax(neighbour, parent, lineLength(map, parent, neighbour));
+                } else {
+                    relax(neighbour, current, map.weighted() ? cost : lineLength(map, current, neighbour));
+                }
+            });
+        }
+
+        ++iterations;
+    }
+
+    if(toEnd) {
+        iteration = iterations;
+    }
+}
+
+unsigned int ThetaStar::heuristic(unsigned int node) const {
+    return lineLength(map, node, map.goal);
+}
+
+// A cell relaxed through an unchecked line of sight that turns out to be
+// blocked takes the expanded neighbour it is cheapest to come from. The one
+// that relaxed it is always there.
+void ThetaStar::setParent(unsigned int node) {
+    unsigned int parent = search.cameFrom(node);
+
+    if(parent == Map::none || lineOfSight(map, parent, node)) {
+        return;
+    }
+
+    Workspace::Cell& cell = search.touch(node);
+    cell.gCost = Map::infinity;
+
+    map.forEachNeighbour(node, [&](unsigned int neighbour, unsigned int) {
+        if(search.closed(neighbour)) {
+            unsigned int newCost = search.gCost(neighbour) + lineLength(map, neighbour, node);
+
+            if(newCost < cell.gCost) {
+                cell.gCost = newCost;
+                cell.cameFrom = neighbour;
+            }
+        }
+    });
+
+    cell.fCost = cell.gCost + heuristic(node);
+}
+
+void ThetaStar::relax(unsigned int neighbour, unsigned int parent, unsigned int cost) {
+    unsigned int newCost = search.gCost(parent) + cost;
+
+    if(newCost < search.gCost(neighbour)) {
+        unsigned int h = heuristic(neighbour);
+        Workspace::Cell& cell = search.touch(neighbour);
+        cell.gCost = newCost;
+        cell.fCost = newCost + h;
+        cell.cameFrom = parent;
+        open(neighbour, ((uint64_t) cell.fCost << 32) | h);
+    }
+}
@@ -0,0 +1,32 @@
+#ifndef __Pathfinding__ThetaStar__
+#define __Pathfinding__ThetaStar__
+
+#include "Search.h"
+
+// Theta*: A* where a cell may take its parent's parent as its own when it can
+// see it, so paths go at any angle and cameFrom links only the corners. Costs
+// are straight-line distances; paths are close to, but not always, the
+// shortest in the plane.
+//
+// The lazy variant assumes the line of sight when it relaxes a cell and only
+// checks it once the cell is expanded, falling back to the best expanded
+// neighbour. That is one check per expansion instead of one per edge.
+//
+// Straight lines ignore cell costs, so on a map with costs it keeps to
+// 8-connected moves like A*.
+class ThetaStar : public PFAlgorithm {
+public:
+    ThetaStar(Map& map, bool lazy = false) : PFAlgorithm(map), lazy(lazy) {}
+
+    virtual void reset();
+    virtual void run(bool toEnd);
+    virtual unsigned int heuristic(unsigned int node) const;
+
+    const bool lazy;
+
+private:
+    void setParent(unsigned int node);
+    void relax(unsigned int neighbour, unsigned int parent, unsigned int cost);
+};
+
+#endif /* defined(__Pathfinding__ThetaStar__) */
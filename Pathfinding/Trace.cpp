@@ -0,0 +1,124 @@
+#include "Trace.h"
+#include <algorithm>
+
+const unsigned int Trace::none;
+const unsigned int Trace::infinity;
+
+void Trace::clear(unsigned int nodes) {
+    events.clear();
+    steps.clear();
+    checkpoints.clear();
+    position = 0;
+    applied = 0;
+
+    if(recording) {
+        head.assign(nodes, none);
+        latest.assign(nodes, none);
+    } else {
+        head.clear();
+        latest.clear();
+    }
+}
+
+void Trace::append(Type type, unsigned int node, unsigned int cameFrom, unsigned int gCost, unsigned int fCost) {
+    unsigned int event = (unsigned int) events.size();
+    events.push_back(Event{node, head[node], cameFrom, gCost, fCost, type});
+    head[node] = event;
+
+    if(applied == event && atEnd()) {
+        latest[node] = event;
+        ++applied;
+    }
+}
+
+void Trace::step(unsigned int node) {
+    if(!recording) {
+        return;
+    }
+
+    unsigned int firstEvent = (unsigned int) events.size();
+    unsigned int lastCheckpoint = checkpoints.empty() ? 0 : checkpoints.back().firstEvent;
+
+    if(firstEvent - lastCheckpoint >= head.size()) {
+        checkpoints.push_back(Checkpoint{firstEvent, head});
+    }
+
+    if(atEnd()) {
+        ++position;
+    }
+
+    steps.push_back(Step{node, firstEvent});
+}
+
+void Trace::seek(unsigned int iteration) {
+    iteration = std::min(iteration, iterations());
+    unsigned int target = endOf(iteration);
+    unsigned int distance = target > applied ? target - applied : applied - target;
+
+    if(distance > latest.size()) {
+        // Walking from a snapshot touches every cell once plus the events after it
+        unsigned int from = 0;
+        const Checkpoint* checkpoint = nullptr;
+
+        for(unsigned int k = 0; k < checkpoints.size() && checkpoints[k].firstEvent <= target; ++k) {
+            checkpoint = &checkpoints[k];
+            from = checkpoint->firstEvent;
+        }
+
+        if(target - from + latest.size() < distance) {
+            if(checkpoint != nullptr) {
+                latest = checkpoint->latest;
+            } else {
+                std::fill(latest.begin(), latest.end(), none);
+            }
+
+            applied = from;
+        }
+    }
+
+    while(applied < target) {
+        latest[events[applied].node] = applied;
+        ++applied;
+    }
+
+    while(applied > target) {
+        --applied;
+        latest[events[applied].node] = events[applied].previous;
+    }
+
+    position = iteration;
+}
+
+bool Trace::isOpen(unsigned int node) const {
+    unsigned int event = latest.empty() ? none : latest[node];
+    return event != none && (events[event].type == opened || events[event].type == relaxed);
+}
+
+bool Trace::isClosed(unsigned int node) const {
+    unsigned int event = latest.empty() ? none : latest[node];
+    return event != none && events[event].type == closed;
+}
+
+unsigned int Trace::cameFrom(unsigned int node) const {
+    unsigned int event = latest.empty() ? none : latest[node];
+    return event != none ? events[event].cameFrom : none;
+}
+
+unsigned int Trace::gCost(unsigned int node) const {
+    unsigned int event = latest.empty() ? none : latest[node];
+    return event != none ? events[event].gCost : infinity;
+}
+
+unsigned int Trace::fCost(unsigned int node) const {
+    unsigned int event = latest.empty() ? none : latest[node];
+    return event != none ? events[event].fCost : infinity;
+}
+
+unsigned int Trace::current() const {
+    return position > 0 ? steps[position - 1].node : none;
+}
+
+// Events [0, endOf(k)) make up the state after k iterations
+unsigned int Trace::endOf(unsigned int iteration) const {
+    return iteration < steps.size() ? steps[iteration].firstEvent : (unsigned int) events.size();
+}
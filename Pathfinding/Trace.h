@@ -0,0 +1,85 @@
+#ifndef __Pathfinding__Trace__
+#define __Pathfinding__Trace__
+
+#include <vector>
+
+// Append-only log of what a search did to each cell. Every event keeps the
+// cell's state after it and the index of the cell's previous event, so a view
+// of the search at any iteration can be moved forward or back one event at a
+// time without running the search again.
+//
+// Snapshots of the latest event per cell are taken every time as many events
+// as there are cells have been logged. Long seeks start from the nearest one,
+// which bounds them by O(cells) for at most a sixth more memory.
+class Trace {
+public:
+    static const unsigned int none = 0xFFFFFFFF;
+    static const unsigned int infinity = 0xFFFFFFFF;
+
+    enum Type : unsigned char { opened, relaxed, closed, removed };
+
+    struct Event {
+        unsigned int node;
+        unsigned int previous;
+        unsigned int cameFrom;
+        unsigned int gCost;
+        unsigned int fCost;
+        Type type;
+    };
+
+    // One per iteration: the node it expanded and where its events start
+    struct Step {
+        unsigned int node;
+        unsigned int firstEvent;
+    };
+
+    Trace() : recording(false), position(0), applied(0) {}
+
+    void clear(unsigned int nodes);
+
+    // Logs a change to a cell. The view follows along if it is at the end.
+    void record(Type type, unsigned int node, unsigned int cameFrom, unsigned int gCost, unsigned int fCost) {
+        if(recording) {
+            append(type, node, cameFrom, gCost, fCost);
+        }
+    }
+
+    // Starts a new iteration that expands the node
+    void step(unsigned int node);
+
+    // Moves the view to the state after the given number of iterations
+    void seek(unsigned int iteration);
+
+    unsigned int iterations() const { return (unsigned int) steps.size(); }
+    bool atEnd() const { return position == steps.size(); }
+
+    // The cells as of the view
+    bool isOpen(unsigned int node) const;
+    bool isClosed(unsigned int node) const;
+    unsigned int cameFrom(unsigned int node) const;
+    unsigned int gCost(unsigned int node) const;
+    unsigned int fCost(unsigned int node) const;
+    unsigned int current() const;
+
+    bool recording;
+    unsigned int position;
+    std::vector<Event> events;
+    std::vector<Step> steps;
+
+private:
+    struct Checkpoint {
+        unsigned int firstEvent;
+        std::vector<unsigned int> latest;
+    };
+
+    void append(Type type, unsigned int node, unsigned int cameFrom, unsigned int gCost, unsigned int fCost);
+    unsigned int endOf(unsigned int iteration) const;
+
+    // Latest event per cell, at the end of the log and in the view
+    std::vector<unsigned int> head;
+    std::vector<unsigned int> latest;
+    unsigned int applied;
+    std::vector<Checkpoint> checkpoints;
+};
+
+#endif /* defined(__Pathfinding__Trace__) */
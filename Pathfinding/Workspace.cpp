@@ -0,0 +1,15 @@
+#include "Workspace.h"
+
+const unsigned int Workspace::none;
+const unsigned int Workspace::infinity;
+
+void Workspace::clear(unsigned int nodes) {
+    ++generation;
+
+    // Stamps start at 0, which no query uses. When the counter wraps around
+    // old stamps could match again, so they are cleared.
+    if(cells.size() != nodes || generation == 0) {
+        cells.assign(nodes, Cell{0, infinity, infinity, none, false});
+        generation = 1;
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef __Pathfinding__Workspace__
+#define __Pathfinding__Workspace__
+
+#include <vector>
+
+// Per-cell search state, reused from one query to the next. A cell's entry
+// only counts if its stamp matches the current generation, so starting a new
+// query bumps the generation instead of rewriting every cell.
+//
+// The fields of a cell sit together so checking the stamp and reading a cost
+// is a single cache line.
+class Workspace {
+public:
+    static const unsigned int none = 0xFFFFFFFF;
+    static const unsigned int infinity = 0xFFFFFFFF;
+
+    struct Cell {
+        unsigned int stamp;
+        unsigned int gCost;
+        unsigned int fCost;
+        unsigned int cameFrom;
+        bool closed;
+    };
+
+    Workspace() : generation(0) {}
+
+    // Starts a new query. O(1) unless the number of cells changed.
+    void clear(unsigned int nodes);
+
+    unsigned int size() const { return (unsigned int) cells.size(); }
+    bool visited(unsigned int node) const { return cells[node].stamp == generation; }
+    bool closed(unsigned int node) const { return visited(node) && cells[node].closed; }
+    unsigned int gCost(unsigned int node) const { return visited(node) ? cells[node].gCost : infinity; }
+    unsigned int fCost(unsigned int node) const { return visited(node) ? cells[node].fCost : infinity; }
+    unsigned int cameFrom(unsigned int node) const { return visited(node) ? cells[node].cameFrom : none; }
+
+    // Brings a cell into the current query so it can be written
+    Cell& touch(unsigned int node) {
+        Cell& cell = cells[node];
+
+        if(cell.stamp != generation) {
+            cell = Cell{generation, infinity, infinity, none, false};
+        }
+
+        return cell;
+    }
+
+private:
+    std::vector<Cell> cells;
+    unsigned int generation;
+};
+
+#endif /* defined(__Pathfinding__Workspace__) */
@@ -2,28 +2,48 @@
 #include <SFML/Graphics.hpp>
 
 #include "ResourcePath.hpp"
+#include <algorithm>
 #include <list>
 #include <string>
 #include <iostream>
 #include <cmath>
 #include "GUI.h"
 #include "Pathfinding.h"
+#include "DStarLite.h"
+#include "JPS.h"
+#include "HPAStar.h"
+#include "ALTStar.h"
+#include "BidirectionalAStar.h"
+#include "FlowField.h"
+#include "ThetaStar.h"
 
-enum class Action { None, DraggingHandle, Painting, Erasing, DraggingRef };
+enum class Action { None, DraggingHandle, Painting, Erasing, DraggingRef, Panning };
 
-sf::RectangleShape makeLine(sf::Vector2f p1, sf::Vector2f p2, float thickness) {
+// Adds a line as a quad so a whole set of them takes one draw call
+void appendLine(sf::VertexArray& lines, sf::Vector2f p1, sf::Vector2f p2, float thickness, sf::Color color) {
     float dx = p2.x - p1.x;
     float dy = p2.y - p1.y;
-    float rot = atan2(dy, dx) * 57.2958;
-    float ht = thickness / 2;
+    float length = std::sqrt(dx * dx + dy * dy);
     
-    sf::RectangleShape rect(sf::Vector2f(std::sqrt(std::abs(dx)*std::abs(dx) + std::abs(dy)*std::abs(dy)), ht*2));
-    rect.setSize(sf::Vector2f(std::sqrt(std::abs(dx)*std::abs(dx) + std::abs(dy)*std::abs(dy)), ht*2));
-    rect.setOrigin(0, 2);
-    rect.setPosition(p1.x, p1.y);
-    rect.setRotation(rot);
-    rect.setFillColor(dark);
-    return rect;
+    if(length == 0) {
+        return;
+    }
+    
+    sf::Vector2f normal(-dy / length * thickness / 2, dx / length * thickness / 2);
+    lines.append(sf::Vertex(p1 - normal, color));
+    lines.append(sf::Vertex(p2 - normal, color));
+    lines.append(sf::Vertex(p2 + normal, color));
+    lines.append(sf::Vertex(p1 + normal, color));
+}
+
+// Iterations a second the search plays at, doubling every 16 steps of the
+// slider; all the way right is as fast as it goes
+unsigned int rateOf(const Slider& slider) {
+    if(slider.value == slider.maxValue) {
+        return 0;
+    }
+    
+    return (unsigned int) std::pow(2.0, slider.value / 16.0);
 }
 
 
@@ -42,6 +62,7 @@ int main(int, char const**) {
     Action action = Action::None;
     NodeRef* draggedRef = nullptr;
     bool mousePressed = false;
+    sf::Vector2i lastMousePos;
     
     // Add GUI elements ---
     unsigned int xSpace = 58;
@@ -53,6 +74,22 @@ int main(int, char const**) {
     radioGroup.addOption(aStarOption);
     RadioOption greedyOption(sf::String(L"Gulosa"), font, &radioGroup);
     radioGroup.addOption(greedyOption);
+    RadioOption dStarLiteOption(sf::String(L"D* Lite"), font, &radioGroup);
+    radioGroup.addOption(dStarLiteOption);
+    RadioOption jpsOption(sf::String(L"JPS"), font, &radioGroup);
+    radioGroup.addOption(jpsOption);
+    RadioOption hpaStarOption(sf::String(L"HPA*"), font, &radioGroup);
+    radioGroup.addOption(hpaStarOption);
+    RadioOption altOption(sf::String(L"ALT"), font, &radioGroup);
+    radioGroup.addOption(altOption);
+    RadioOption bidirectionalOption(sf::String(L"A* bidir."), font, &radioGroup);
+    radioGroup.addOption(bidirectionalOption);
+    RadioOption flowFieldOption(sf::String(L"Campo"), font, &radioGroup);
+    radioGroup.addOption(flowFieldOption);
+    RadioOption thetaStarOption(sf::String(L"Theta*"), font, &radioGroup);
+    radioGroup.addOption(thetaStarOption);
+    RadioOption lazyThetaStarOption(sf::String(L"Lazy Theta*"), font, &radioGroup);
+    radioGroup.addOption(lazyThetaStarOption);
     ySpace += radioGroup.getHeight() + 12;
     
     Button cleanButton(sf::String(L"Limpar"), 162, font, 20);
@@ -86,10 +123,20 @@ int main(int, char const**) {
 
     // ------------------------
     
-    AStar aStar(grid);
-    Greedy greedy(grid);
-    grid.algorithm = &aStar;
-    grid.updateHeuristics();
+    AStar aStar(grid.map);
+    Greedy greedy(grid.map);
+    DStarLite dStarLite(grid.map);
+    JPS jps(grid.map);
+    HPAStar hpaStar(grid.map, 5);
+    ALTStar alt(grid.map, 4);
+    BidirectionalAStar bidirectional(grid.map);
+    FlowField flowField(grid.map);
+    ThetaStar thetaStar(grid.map);
+    ThetaStar lazyThetaStar(grid.map, true);
+    grid.setAlgorithm(&aStar);
+    grid.setRate(rateOf(slider));
+    
+    sf::VertexArray lines(sf::Quads);
     
     while(window.isOpen()) {
         sf::Event event;
@@ -102,117 +149,181 @@ int main(int, char const**) {
             if(event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape) {
                 window.close();
             }
+
+            if(event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::S) {
+                grid.save("grid.pfmap");
+            }
+
+            if(event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::L) {
+                grid.load("grid.pfmap");
+            }
+            
+            if(event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Left) {
+                grid.pan(sf::Vector2f(64, 0));
+            }
+            
+            if(event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Right) {
+                grid.pan(sf::Vector2f(-64, 0));
+            }
+            
+            if(event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Up) {
+                grid.pan(sf::Vector2f(0, 64));
+            }
+            
+            if(event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Down) {
+                grid.pan(sf::Vector2f(0, -64));
+            }
+            
+            if(event.type == sf::Event::MouseWheelScrolled) {
+                sf::Vector2i mousePos(event.mouseWheelScroll.x, event.mouseWheelScroll.y);
+                
+                if(grid.contains(mousePos)) {
+                    grid.zoomAt(mousePos, std::pow(1.25f, event.mouseWheelScroll.delta));
+                }
+            }
             
             if(event.type == sf::Event::MouseButtonPressed) {
                 sf::Vector2i mousePos = sf::Mouse::getPosition(window);
-                sf::Vector2f mousePosF = sf::Vector2f(mousePos.x, mousePos.y);
+                unsigned int i, j;
                 
                 mousePressed = true;
+                lastMousePos = mousePos;
                 
-                if(grid.contains(mousePos)) {
-                    if(grid.start.contains(mousePos)) {
+                if(grid.contains(mousePos) && event.mouseButton.button == sf::Mouse::Right) {
+                    action = Action::Panning;
+                } else if(grid.contains(mousePos)) {
+                    if(grid.start.contains(grid.toGrid(mousePos))) {
                         action = Action::DraggingRef;
                         draggedRef = &grid.start;
-                    } else if(grid.goal.contains(mousePos)) {
+                    } else if(grid.goal.contains(grid.toGrid(mousePos))) {
                         action = Action::DraggingRef;
                         draggedRef = &grid.goal;
-                    } else {
-                        for(int i = 0; i < grid.columns; ++i) {
-                            for(int j = 0; j < grid.rows; ++j) {
-                                if(grid.nodes[i][j]->contains(mousePos)) {
-                                    if(!grid.nodes[i][j]->getWall()) {
-                                        grid.setWall(i,j, true);
-                                        action = Action::Painting;
-                                    } else {
-                                        grid.setWall(i, j, false);
-                                        action = Action::Erasing;
-                                    }
-                                }
-                            }
+                    } else if(grid.cellAt(mousePos, i, j)) {
+                        if(!grid.getWall(i, j)) {
+                            grid.setWall(i,j, true);
+                            action = Action::Painting;
+                        } else {
+                            grid.setWall(i, j, false);
+                            action = Action::Erasing;
                         }
                     }
                 }
                 
+                if(slider.contains(mousePos)) {
+                    action = Action::DraggingHandle;
+                    slider.setFromPoint(mousePos);
+                    grid.setRate(rateOf(slider));
+                }
+                
                 if(cleanButton.contains(mousePos)) {
                     grid.clearWalls();
                 }
                 
                 if(iterateButton.contains(mousePos)) {
-                    grid.algorithm->iterate();
+                    grid.iterate();
                 }
 
                 if(rewindButton.contains(mousePos)) {
-                    grid.algorithm->rewind();
+                    grid.rewind();
                 }
                 
                 if(endButton.contains(mousePos)) {
-                    grid.algorithm->toEnd();
+                    grid.toEnd();
                 }
                 
                 if(resetButton.contains(mousePos)) {
-                    grid.algorithm->toStart();
+                    grid.toStart();
                 }
                 
                 if(aStarOption.contains(mousePos)) {
                     radioGroup.selectOption(&aStarOption);
-                    grid.algorithm = &aStar;
-                    grid.updateHeuristics();
+                    grid.setAlgorithm(&aStar);
                 }
                 
                 if(greedyOption.contains(mousePos)) {
                     radioGroup.selectOption(&greedyOption);
-                    grid.algorithm = &greedy;
-                    grid.updateHeuristics();
+                    grid.setAlgorithm(&greedy);
+                }
+                
+                if(dStarLiteOption.contains(mousePos)) {
+                    radioGroup.selectOption(&dStarLiteOption);
+                    grid.setAlgorithm(&dStarLite);
+                }
+                
+                if(jpsOption.contains(mousePos)) {
+                    radioGroup.selectOption(&jpsOption);
+                    grid.setAlgorithm(&jps);
+                }
+                
+                if(hpaStarOption.contains(mousePos)) {
+                    radioGroup.selectOption(&hpaStarOption);
+                    grid.setAlgorithm(&hpaStar);
+                }
+                
+                if(altOption.contains(mousePos)) {
+                    radioGroup.selectOption(&altOption);
+                    grid.setAlgorithm(&alt);
+                }
+                
+                if(bidirectionalOption.contains(mousePos)) {
+                    radioGroup.selectOption(&bidirectionalOption);
+                    grid.setAlgorithm(&bidirectional);
+                }
+                
+                if(flowFieldOption.contains(mousePos)) {
+                    radioGroup.selectOption(&flowFieldOption);
+                    grid.setAlgorithm(&flowField);
+                }
+                
+                if(thetaStarOption.contains(mousePos)) {
+                    radioGroup.selectOption(&thetaStarOption);
+                    grid.setAlgorithm(&thetaStar);
+                }
+                
+                if(lazyThetaStarOption.contains(mousePos)) {
+                    radioGroup.selectOption(&lazyThetaStarOption);
+                    grid.setAlgorithm(&lazyThetaStar);
                 }
             }
             
             if(event.type == sf::Event::MouseMoved) {
                 sf::Vector2i mousePos = sf::Mouse::getPosition(window);
-                sf::Vector2f mousePosF = sf::Vector2f(mousePos.x, mousePos.y);
+                unsigned int i, j;
                 
-                if(action == Action::DraggingRef) {
-                    draggedRef->moveToMousePosition(mousePosF);
-                } else if(grid.contains(mousePos)) {
-                    for(int i = 0; i < grid.columns; ++i) {
-                        for(int j = 0; j < grid.rows; ++j) {
-                            if(grid.nodes[i][j]->contains(mousePos)) {
-                                if(action == Action::Painting) {
-                                    if(grid.nodes[i][j] != grid.goal.node &&
-                                       grid.nodes[i][j] != grid.start.node)
-                                    {
-                                        grid.setWall(i, j, true);
-                                    }
-                                } else if(action == Action::Erasing) {
-                                    grid.setWall(i, j, false);
-                                }
-                            }
+                if(action == Action::DraggingHandle) {
+                    slider.setFromPoint(mousePos);
+                    grid.setRate(rateOf(slider));
+                } else if(action == Action::Panning) {
+                    grid.pan(sf::Vector2f(mousePos.x - lastMousePos.x, mousePos.y - lastMousePos.y));
+                } else if(action == Action::DraggingRef) {
+                    draggedRef->moveToMousePosition(grid.toGrid(mousePos));
+                } else if(grid.cellAt(mousePos, i, j)) {
+                    unsigned int index = grid.map.index(i, j);
+                    
+                    if(action == Action::Painting) {
+                        if(index != grid.goal.index && index != grid.start.index) {
+                            grid.setWall(i, j, true);
                         }
+                    } else if(action == Action::Erasing) {
+                        grid.setWall(i, j, false);
                     }
                 }
+                
+                lastMousePos = mousePos;
             }
             
             if(event.type == sf::Event::MouseButtonReleased) {
                 sf::Vector2i mousePos = sf::Mouse::getPosition(window);
-                sf::Vector2f mousePosF = sf::Vector2f(mousePos.x, mousePos.y);
+                unsigned int i, j;
                 
                 mousePressed = false;
                 
                 if(action == Action::DraggingRef) {
-                    if(grid.contains(mousePos)) {
-                        for(int i = 0; i < grid.columns; ++i) {
-                            for(int j = 0; j < grid.rows; ++j) {
-                                if((grid.nodes[i][j]->contains(mousePos) ||
-                                    grid.nodes[i][j]->contains(mousePos + sf::Vector2i(1, 1))) &&
-                                   grid.nodes[i][j] != grid.start.node &&
-                                   grid.nodes[i][j] != grid.goal.node)
-                                {
-                                    draggedRef->setNode(grid.nodes[i][j]);
-                                    grid.setWall(i, j, false);
-                                } else {
-                                    draggedRef->moveToNode();
-                                }
-                            }
-                        }
+                    if(grid.cellAt(mousePos, i, j) &&
+                       grid.map.index(i, j) != grid.start.index &&
+                       grid.map.index(i, j) != grid.goal.index)
+                    {
+                        grid.setRef(draggedRef, i, j);
                     } else {
                         draggedRef->moveToNode();
                     }
@@ -224,6 +335,7 @@ int main(int, char const**) {
 
         }
         
+        grid.update();
         window.clear(sf::Color::White);
 
         window.draw(radioGroup);
@@ -235,49 +347,53 @@ int main(int, char const**) {
         window.draw(slider);
         window.draw(grid);
         
+        sf::Color faded = dark;
+        faded.a = 50;
+        lines.clear();
+        
+        // Links are only drawn for the cells in view, and not once cells are
+        // too small to tell them apart
+        sf::IntRect visible = grid.visibleCells();
+        bool detailed = grid.pitch.x * grid.zoom >= 8;
+        
         /*
-        for(int i = 0; i < grid.columns; ++i) {
-            for(int j = 0; j < grid.rows; ++j) {
-                for(Node* neighbour : grid.nodes[i][j]->neighbours) {
-                    if(!grid.nodes[i][j]->getWall() && !neighbour->getWall()) {
-                        sf::RectangleShape rect = makeLine(grid.nodes[i][j]->center(), neighbour->center(), 2);
-                        sf::Color color = rect.getFillColor();
-                        color.a = 50;
-                        rect.setFillColor(color);
-                        window.draw(rect);
-                    }
-                }
+        for(int i = visible.left; i < visible.left + visible.width; ++i) {
+            for(int j = visible.top; j < visible.top + visible.height; ++j) {
+                grid.map.forEachNeighbour(grid.map.index(i, j), [&](unsigned int neighbour, unsigned int) {
+                    appendLine(lines, grid.center(grid.map.index(i, j)), grid.center(neighbour), 2, faded);
+                });
             }
         }
          */
         
-        if(grid.goal.node->cameFrom == nullptr) {
-            for(int i = 0; i < grid.columns; ++i) {
-                for(int j = 0; j < grid.rows; ++j) {
-                    for(Node* neighbour : grid.nodes[i][j]->neighbours) {
-                        if(!grid.nodes[i][j]->getWall() && !neighbour->getWall()) {
-                            if(grid.nodes[i][j]->cameFrom != nullptr) {
-                                sf::RectangleShape rect = makeLine(grid.nodes[i][j]->center(), grid.nodes[i][j]->cameFrom->center(), 2);
-                                sf::Color color = rect.getFillColor();
-                                color.a = 50;
-                                rect.setFillColor(color);
-                                window.draw(rect);
-                            }
-                        }
+        // The path only exists once the view has caught up with the search.
+        // Neither is drawn while the worker has it.
+        const Trace& trace = grid.map.algorithm->trace;
+        std::vector<unsigned int> path;
+        
+        if(!grid.searching() && trace.atEnd()) {
+            path = grid.map.algorithm->path();
+        }
+        
+        if(!grid.searching() && path.empty() && detailed) {
+            for(int i = visible.left; i < visible.left + visible.width; ++i) {
+                for(int j = visible.top; j < visible.top + visible.height; ++j) {
+                    unsigned int index = grid.map.index(i, j);
+                    
+                    if(!grid.map.wall(index) && trace.cameFrom(index) != Map::none) {
+                        appendLine(lines, grid.center(index), grid.center(trace.cameFrom(index)), 2, faded);
                     }
                 }
             }
         }
         
-        
-        Node* node = grid.goal.node;
-        
-        while(node != grid.start.node && node->cameFrom != nullptr) {
-            sf::RectangleShape rect = makeLine(node->center(), node->cameFrom->center(), 2);
-            window.draw(rect);
-            node = node->cameFrom;
+        for(unsigned int i = 1; i < path.size(); ++i) {
+            appendLine(lines, grid.center(path[i - 1]), grid.center(path[i]), 2 / std::min(grid.zoom, 1.f), dark);
         }
         
+        window.setView(grid.view(window));
+        window.draw(lines);
+        window.setView(window.getDefaultView());
         window.display();
     }
 
@@ -0,0 +1,812 @@
+// Checks the searches and the structures under them against brute-force
+// answers on random maps:
+//
+//   tests [optimal|incremental|connectivity|mapfile|lineofsight|batch|trace|worker]...
+//
+// With no names every group runs. Exits with 1 if any check failed.
+
+#include "Algorithms.h"
+#include "Batch.h"
+#include "Flood.h"
+#include "Landmarks.h"
+#include "LineOfSight.h"
+#include "Map.h"
+#include "MapFile.h"
+#include "SearchWorker.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static unsigned int failures = 0;
+
+static void check(bool condition, const std::string& what) {
+    if(!condition) {
+        if(failures < 20) {
+            std::cerr << "failed: " << what << "\n";
+        }
+
+        ++failures;
+    }
+}
+
+// Exact searches must match Dijkstra's cost; the others only need a valid path
+static bool exact(const std::string& name) {
+    return name == "astar" || name == "dstarlite" || name == "jps" || name == "alt" ||
+           name == "bidirectional" || name == "flowfield";
+}
+
+// Searches whose edit hooks repair what they kept and run on to the end
+static bool repairs(const std::string& name) {
+    return name == "dstarlite" || name == "flowfield";
+}
+
+static bool anyAngle(const std::string& name) {
+    return name == "theta" || name == "lazytheta";
+}
+
+static unsigned int randomFree(const Map& map, std::mt19937& rng) {
+    unsigned int node;
+
+    do {
+        node = rng() % map.size();
+    } while(map.wall(node));
+
+    return node;
+}
+
+// Scattered blocks of walls, and cell costs from 1 to 9 if weighted. Start and
+// goal are random free cells.
+static void randomMap(Map& map, std::mt19937& rng, unsigned int blocks, bool weighted) {
+    map.beginEdit();
+    map.clearWalls();
+    map.clearCosts();
+
+    for(unsigned int b = 0; b < blocks; ++b) {
+        unsigned int i = rng() % map.columns;
+        unsigned int j = rng() % map.rows;
+        map.fillWalls(i, j, i + 1 + rng() % 4, j + 1 + rng() % 4, true);
+    }
+
+    if(weighted) {
+        for(unsigned int node = 0; node < map.size(); ++node) {
+            map.setCost(map.column(node), map.row(node), (uint8_t) (1 + rng() % 9));
+        }
+    }
+
+    map.commitEdit();
+    map.start = randomFree(map, rng);
+    map.goal = randomFree(map, rng);
+}
+
+static std::vector<unsigned int> dijkstra(const Map& map, unsigned int source) {
+    typedef std::pair<unsigned int, unsigned int> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > open;
+    std::vector<unsigned int> distance(map.size(), Map::infinity);
+
+    distance[source] = 0;
+    open.push(Entry(0, source));
+
+    while(!open.empty()) {
+        Entry entry = open.top();
+        open.pop();
+
+        if(entry.first != distance[entry.second]) {
+            continue;
+        }
+
+        map.forEachNeighbour(entry.second, [&](unsigned int neighbour, unsigned int cost) {
+            if(entry.first + cost < distance[neighbour]) {
+                distance[neighbour] = entry.first + cost;
+                open.push(Entry(distance[neighbour], neighbour));
+            }
+        });
+    }
+
+    return distance;
+}
+
+// The cost of a path of moves from start to goal, or Map::infinity if it
+// isn't one
+static unsigned int pathCost(const Map& map, const std::vector<unsigned int>& path) {
+    if(path.empty() || path.front() != map.start || path.back() != map.goal) {
+        return Map::infinity;
+    }
+
+    unsigned int total = 0;
+
+    for(unsigned int k = 1; k < path.size(); ++k) {
+        unsigned int step = Map::infinity;
+
+        map.forEachNeighbour(path[k - 1], [&](unsigned int neighbour, unsigned int cost) {
+            if(neighbour == path[k]) step = cost;
+        });
+
+        if(step == Map::infinity) {
+            return Map::infinity;
+        }
+
+        total += step;
+    }
+
+    return total;
+}
+
+static bool visiblePath(const Map& map, const std::vector<unsigned int>& path) {
+    if(path.empty() || path.front() != map.start || path.back() != map.goal) {
+        return false;
+    }
+
+    for(unsigned int k = 1; k < path.size(); ++k) {
+        if(!lineOfSight(map, path[k - 1], path[k])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Checks the path an algorithm found against the shortest distance
+static void checkPath(const Map& map, const std::string& name, const std::vector<unsigned int>& path,
+                      unsigned int shortest, const std::string& where)
+{
+    std::string what = name + " " + where;
+
+    if(shortest == Map::infinity) {
+        check(path.empty(), what + ": found a path that doesn't exist");
+    } else if(exact(name)) {
+        check(pathCost(map, path) == shortest, what + ": cost isn't the shortest");
+    } else if(anyAngle(name) && !map.weighted()) {
+        check(visiblePath(map, path), what + ": a segment crosses a wall");
+    } else {
+        check(pathCost(map, path) != Map::infinity, what + ": no valid path");
+    }
+}
+
+// Costs up to 255 make the distances too long for 16 bits, so the tables
+// count in coarser units. The bound has to stay admissible and consistent
+// across every move.
+static void landmarkBounds() {
+    std::mt19937 rng(7);
+    Map map(40, 40);
+
+    for(unsigned int trial = 0; trial < 4; ++trial) {
+        randomMap(map, rng, 100, false);
+
+        for(unsigned int node = 0; node < map.size(); ++node) {
+            map.setCost(map.column(node), map.row(node), (uint8_t) (1 + rng() % 255));
+        }
+
+        Landmarks landmarks(4);
+        landmarks.build(map);
+
+        unsigned int goal = randomFree(map, rng);
+        std::vector<unsigned int> distance = dijkstra(map, goal);
+
+        for(unsigned int node = 0; node < map.size(); ++node) {
+            unsigned int bound = landmarks.lowerBound(node, goal);
+
+            if(map.wall(node) || distance[node] == Map::infinity) {
+                continue;
+            }
+
+            check(bound <= distance[node], "landmark bound admissible");
+
+            map.forEachNeighbour(node, [&](unsigned int neighbour, unsigned int cost) {
+                check(bound <= cost + landmarks.lowerBound(neighbour, goal), "landmark bound consistent");
+            });
+        }
+    }
+}
+
+static void optimal() {
+    std::mt19937 rng(1);
+    Map map(48, 48);
+
+    for(unsigned int trial = 0; trial < 40; ++trial) {
+        map.cutCorners = trial % 2 == 1;
+        randomMap(map, rng, 250, trial % 4 >= 2);
+        unsigned int shortest = dijkstra(map, map.start)[map.goal];
+
+        for(unsigned int k = 0; k < algorithmCount; ++k) {
+            std::unique_ptr<PFAlgorithm> algorithm(algorithms[k].make(map));
+            algorithm->reset();
+            algorithm->run(true);
+
+            std::ostringstream where;
+            where << "trial " << trial;
+            checkPath(map, algorithms[k].name, algorithm->path(), shortest, where.str());
+        }
+    }
+
+    landmarkBounds();
+}
+
+// Batches large enough to matter but under the size that rebuilds, so they go
+// through the repair of every cell in them
+static void largeBatches() {
+    const char* names[] = { "dstarlite", "flowfield" };
+
+    for(const char* name : names) {
+        std::mt19937 rng(8);
+        Map map(64, 64);
+        std::unique_ptr<PFAlgorithm> algorithm(makeAlgorithm(name, map));
+
+        randomMap(map, rng, 300, false);
+        map.algorithm = algorithm.get();
+        algorithm->trace.recording = true;
+        map.updateHeuristics();
+        algorithm->toEnd();
+
+        for(unsigned int edit = 0; edit < 30; ++edit) {
+            unsigned int i = rng() % map.columns;
+            unsigned int j = rng() % map.rows;
+            bool wall = rng() % 2 == 0;
+
+            map.beginEdit();
+
+            if(edit % 3 == 0) {
+                map.paintWalls(i, j, 4 + rng() % 8, wall);
+            } else {
+                map.fillWalls(i, j, i + 10 + rng() % 30, j + 10 + rng() % 30, wall);
+            }
+
+            map.setWall(map.column(map.start), map.row(map.start), false);
+            map.setWall(map.column(map.goal), map.row(map.goal), false);
+            map.commitEdit();
+
+            std::ostringstream where;
+            where << "large batch " << edit;
+            checkPath(map, name, algorithm->path(), dijkstra(map, map.start)[map.goal], where.str());
+        }
+
+        map.algorithm = nullptr;
+    }
+}
+
+// Edits a repairing search can't repair and rebuilds instead, starting from a
+// small pocket so the first search stops long before the rebuilt one would
+static void rebuilds() {
+    const char* names[] = { "dstarlite", "flowfield" };
+
+    for(const char* name : names) {
+        Map map(60, 60);
+        std::unique_ptr<PFAlgorithm> algorithm(makeAlgorithm(name, map));
+
+        map.fillWalls(0, 0, 60, 60, true);
+        map.fillWalls(10, 10, 13, 13, false);
+        map.setStart(10, 10);
+        map.setGoal(12, 12);
+        map.algorithm = algorithm.get();
+        algorithm->trace.recording = true;
+        map.updateHeuristics();
+        algorithm->toEnd();
+
+        std::vector<std::function<void()> > edits;
+
+        edits.push_back([&]() {
+            map.beginEdit();
+            map.fillWalls(10, 10, 40, 40, false);
+            map.setCost(20, 20, 5);
+            map.commitEdit();
+        });
+
+        edits.push_back([&]() { map.setStart(35, 35); });
+
+        // Batches over most of the map, back to the pocket and then open
+        edits.push_back([&]() { map.setStart(11, 11); });
+
+        edits.push_back([&]() {
+            map.beginEdit();
+            map.fillWalls(0, 0, 60, 60, true);
+            map.fillWalls(10, 10, 13, 13, false);
+            map.commitEdit();
+        });
+
+        edits.push_back([&]() { map.clearWalls(); });
+        edits.push_back([&]() { map.setStart(55, 55); });
+
+        // A walled goal has no path until it is free again
+        edits.push_back([&]() { map.setWall(12, 12, true); });
+        edits.push_back([&]() { map.setWall(12, 12, false); });
+
+        for(unsigned int k = 0; k < edits.size(); ++k) {
+            edits[k]();
+
+            std::ostringstream where;
+            where << "rebuild " << k;
+            checkPath(map, name, algorithm->path(), dijkstra(map, map.start)[map.goal], where.str());
+        }
+
+        // An edit before the search has taken a step
+        std::unique_ptr<PFAlgorithm> fresh(makeAlgorithm(name, map));
+        map.algorithm = fresh.get();
+        fresh->trace.recording = true;
+        map.setWall(30, 30, true);
+        checkPath(map, name, fresh->path(), dijkstra(map, map.start)[map.goal], "edit before searching");
+
+        map.algorithm = nullptr;
+    }
+}
+
+// Every kind of edit against a fresh Dijkstra. Searches that repair their
+// state have to be at the end already; the others run on from whatever they
+// kept.
+static void incremental() {
+    for(unsigned int k = 0; k < algorithmCount; ++k) {
+        std::mt19937 rng(2 + k);
+        Map map(40, 40);
+        std::unique_ptr<PFAlgorithm> algorithm(algorithms[k].make(map));
+
+        randomMap(map, rng, 150, false);
+        map.algorithm = algorithm.get();
+        algorithm->trace.recording = true;
+        map.updateHeuristics();
+        algorithm->toEnd();
+
+        for(unsigned int edit = 0; edit < 80; ++edit) {
+            unsigned int i = rng() % map.columns;
+            unsigned int j = rng() % map.rows;
+
+            switch(rng() % 6) {
+                case 0:
+                    if(map.index(i, j) != map.start && map.index(i, j) != map.goal) {
+                        map.setWall(i, j, !map.getWall(i, j));
+                    }
+                    break;
+                case 1:
+                    map.beginEdit();
+                    map.paintWalls(i, j, rng() % 3, rng() % 2 == 0);
+                    map.fillWalls(j, i, j + rng() % 5, i + rng() % 5, rng() % 2 == 0);
+                    map.setWall(map.column(map.start), map.row(map.start), false);
+                    map.setWall(map.column(map.goal), map.row(map.goal), false);
+                    map.commitEdit();
+                    break;
+                case 2:
+                    map.setStart(i, j);
+                    break;
+                case 3:
+                    map.setGoal(i, j);
+                    break;
+                case 4:
+                    map.setCost(i, j, (uint8_t) (1 + rng() % 9));
+                    break;
+                case 5: {
+                    uint64_t bits = ((uint64_t) rng() << 32) | rng();
+                    map.beginEdit();
+                    map.writeWalls(i, j, 8, 8, &bits);
+                    map.setWall(map.column(map.start), map.row(map.start), false);
+                    map.setWall(map.column(map.goal), map.row(map.goal), false);
+                    map.commitEdit();
+                    break;
+                }
+            }
+
+            if(!repairs(algorithms[k].name)) {
+                algorithm->toEnd();
+            }
+
+            std::ostringstream where;
+            where << "edit " << edit;
+            checkPath(map, algorithms[k].name, algorithm->path(), dijkstra(map, map.start)[map.goal], where.str());
+        }
+
+        map.algorithm = nullptr;
+    }
+
+    largeBatches();
+    rebuilds();
+}
+
+// Breadth-first move counts
+static std::vector<unsigned int> moves(const Map& map, unsigned int source) {
+    std::vector<unsigned int> distance(map.size(), Map::infinity);
+    std::queue<unsigned int> open;
+
+    distance[source] = 0;
+    open.push(source);
+
+    while(!open.empty()) {
+        unsigned int node = open.front();
+        open.pop();
+
+        map.forEachNeighbour(node, [&](unsigned int neighbour, unsigned int) {
+            if(distance[neighbour] == Map::infinity) {
+                distance[neighbour] = distance[node] + 1;
+                open.push(neighbour);
+            }
+        });
+    }
+
+    return distance;
+}
+
+// Rows wider than a word, so the flood carries bits between words
+static void connectivity() {
+    std::mt19937 rng(3);
+    Map map(50, 150);
+
+    for(unsigned int trial = 0; trial < 20; ++trial) {
+        map.cutCorners = trial % 2 == 1;
+        randomMap(map, rng, 1200 + 40 * trial, false);
+        Flood flood(map);
+
+        for(unsigned int round = 0; round < 5; ++round) {
+            unsigned int source = randomFree(map, rng);
+            std::vector<unsigned int> expected = moves(map, source);
+            std::vector<unsigned int> distance;
+            unsigned int reached = 0;
+
+            flood.update();
+            map.updateComponents();
+
+            unsigned int count = flood.distances(std::vector<unsigned int>(1, source), distance);
+
+            for(unsigned int node = 0; node < map.size(); ++node) {
+                bool connected = expected[node] != Map::infinity;
+                reached += connected;
+
+                check(distance[node] == expected[node], "flood distance");
+                check(flood.reached(node) == connected, "flood reached");
+                check(map.connected(source, node) == connected || map.wall(node), "components");
+            }
+
+            check(count == reached, "flood count");
+
+            unsigned int target = randomFree(map, rng);
+            check(flood.connected(source, target) == (expected[target] != Map::infinity), "flood connected");
+
+            // Splits and merges go through the union-find before the next round
+            for(unsigned int edit = 0; edit < 30; ++edit) {
+                map.setWall(rng() % map.columns, rng() % map.rows, rng() % 3 != 0);
+            }
+        }
+    }
+
+    // A wall painted on and off many times between queries, past the point
+    // where the freed cells' elements make the labels rebuild
+    std::mt19937 paint(6);
+    randomMap(map, paint, 1500, false);
+    map.updateComponents();
+
+    for(unsigned int stroke = 0; stroke < 3 * map.size(); ++stroke) {
+        unsigned int i = paint() % map.columns;
+        unsigned int j = paint() % map.rows;
+        map.setWall(i, j, true);
+        map.setWall(i, j, false);
+
+        if(stroke % 5000 == 0) {
+            unsigned int source = randomFree(map, paint);
+            std::vector<unsigned int> expected = moves(map, source);
+            map.updateComponents();
+
+            for(unsigned int node = 0; node < map.size(); ++node) {
+                check(map.connected(source, node) == (expected[node] != Map::infinity) || map.wall(node),
+                      "components after painting");
+            }
+        }
+    }
+}
+
+static void mapFile() {
+    std::mt19937 rng(4);
+    Map map(37, 71);
+    Landmarks landmarks(4);
+    const char* path = "tests.pfmap";
+
+    randomMap(map, rng, 200, true);
+    landmarks.build(map);
+    check(MapFile::save(path, map, &landmarks), "save");
+
+    Map loaded(1, 1);
+    Landmarks tables(4);
+    MapFile file;
+
+    check(file.open(path) && file.load(loaded), "open and load");
+    check(loaded.rows == map.rows && loaded.columns == map.columns, "size");
+    check(loaded.start == map.start && loaded.goal == map.goal, "start and goal");
+    check(std::equal(map.walls.begin(), map.walls.end(), loaded.walls.begin()), "walls");
+    check(loaded.costs == map.costs, "costs");
+    check(file.loadLandmarks(tables, loaded) && tables.nodes == landmarks.nodes, "landmarks");
+
+    for(unsigned int k = 0; k < 200 && tables.nodes == landmarks.nodes; ++k) {
+        unsigned int a = rng() % map.size();
+        unsigned int b = rng() % map.size();
+        check(tables.lowerBound(a, b) == landmarks.lowerBound(a, b), "landmark bounds");
+    }
+
+    file.close();
+
+    // A file of the other byte order is refused
+    uint32_t swapped = 0x04030201;
+    std::fstream patch(path, std::ios::in | std::ios::out | std::ios::binary);
+    patch.seekp(28);
+    patch.write((const char*) &swapped, sizeof(swapped));
+    patch.close();
+    check(!file.open(path), "byte order");
+    std::remove(path);
+
+    // MovingAI text maps
+    const char* text = "tests.map";
+    std::ofstream out(text);
+    out << "type octile\nheight " << map.rows << "\nwidth " << map.columns << "\nmap\n";
+
+    for(unsigned int j = 0; j < map.rows; ++j) {
+        for(unsigned int i = 0; i < map.columns; ++i) {
+            out << (map.getWall(i, j) ? '@' : '.');
+        }
+
+        out << "\n";
+    }
+
+    out.close();
+    check(MapFile::importMovingAI(text, loaded), "import");
+    check(std::equal(map.walls.begin(), map.walls.end(), loaded.walls.begin()) && !loaded.weighted(), "imported walls");
+    std::remove(text);
+}
+
+// Whether the segment between the cell centres crosses the inside of a wall
+// cell, or passes through a corner next to one without cutting corners. In
+// doubled coordinates, so centres and corners are whole numbers.
+static bool sight(const Map& map, unsigned int a, unsigned int b) {
+    if(a == b) {
+        return !map.wall(a);
+    }
+
+    long x0 = 2 * map.column(a) + 1, y0 = 2 * map.row(a) + 1;
+    long x1 = 2 * map.column(b) + 1, y1 = 2 * map.row(b) + 1;
+    long dx = x1 - x0, dy = y1 - y0;
+
+    for(unsigned int j = 0; j < map.rows; ++j) {
+        for(unsigned int i = 0; i < map.columns; ++i) {
+            long x = 2 * i, y = 2 * j;
+
+            if(x >= std::max(x0, x1) || x + 2 <= std::min(x0, x1) || y >= std::max(y0, y1) || y + 2 <= std::min(y0, y1)) {
+                continue;
+            }
+
+            bool above = false, below = false;
+
+            for(long cx = x; cx <= x + 2; cx += 2) {
+                for(long cy = y; cy <= y + 2; cy += 2) {
+                    long side = dy * (cx - x0) - dx * (cy - y0);
+                    above = above || side > 0;
+                    below = below || side < 0;
+                }
+            }
+
+            if(above && below && map.wall(map.index(i, j))) {
+                return false;
+            }
+
+            bool corner = dy * (x - x0) - dx * (y - y0) == 0 && i > 0 && j > 0 &&
+                          x > std::min(x0, x1) && x < std::max(x0, x1);
+
+            if(corner && !map.cutCorners &&
+               (map.wall(map.index(i - 1, j - 1)) || map.wall(map.index(i, j - 1)) ||
+                map.wall(map.index(i - 1, j)) || map.wall(map.index(i, j))))
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static void lineOfSightChecks() {
+    std::mt19937 rng(5);
+    Map map(30, 90);
+
+    for(unsigned int trial = 0; trial < 8; ++trial) {
+        map.cutCorners = trial % 2 == 1;
+        randomMap(map, rng, 150, false);
+
+        for(unsigned int query = 0; query < 3000; ++query) {
+            unsigned int a = rng() % map.size();
+            unsigned int b = rng() % map.size();
+
+            // Diagonals and straight lines, where the corner and row cases are
+            if(query % 3 == 1) {
+                unsigned int d = rng() % 30;
+                b = map.index(std::min(map.columns - 1, map.column(a) + d), std::min(map.rows - 1, map.row(a) + d));
+            } else if(query % 3 == 2) {
+                b = map.index(rng() % map.columns, map.row(a));
+            }
+
+            check(lineOfSight(map, a, b) == sight(map, a, b), "line of sight");
+            check(lineOfSight(map, a, b) == lineOfSight(map, b, a), "line of sight both ways");
+        }
+
+        std::unique_ptr<PFAlgorithm> algorithm(makeAlgorithm("astar", map));
+        algorithm->reset();
+        algorithm->run(true);
+        std::vector<unsigned int> path = algorithm->path();
+        std::vector<unsigned int> pulled = pullString(map, path);
+
+        check(path.empty() == pulled.empty(), "pulled path");
+        check(path.empty() || (visiblePath(map, pulled) && pulled.size() <= path.size()), "pulled path is visible");
+        check(std::includes(path.begin(), path.end(), pulled.begin(), pulled.end(), [&](unsigned int x, unsigned int y) {
+            return std::find(path.begin(), path.end(), x) < std::find(path.begin(), path.end(), y);
+        }), "pulled path keeps its corners in order");
+    }
+}
+
+// The threaded batch against single-threaded A*, query by query
+static void batch() {
+    std::mt19937 rng(9);
+    Map map(80, 80);
+    randomMap(map, rng, 700, false);
+
+    std::vector<Query> queries;
+
+    for(unsigned int q = 0; q < 300; ++q) {
+        queries.push_back(Query{(unsigned int)(rng() % map.size()), (unsigned int)(rng() % map.size())});
+    }
+
+    Batch threaded(map, 4);
+    Batch single(map, 1);
+    std::vector<std::vector<unsigned int> > paths = threaded.run(queries);
+    std::vector<std::vector<unsigned int> > expected = single.run(queries);
+    AStar astar(map);
+
+    check(paths.size() == queries.size(), "one path per query");
+
+    for(unsigned int q = 0; q < queries.size() && q < paths.size(); ++q) {
+        map.start = queries[q].start;
+        map.goal = queries[q].goal;
+        astar.reset();
+        astar.run(true);
+
+        unsigned int cost = pathCost(map, astar.path());
+        check(pathCost(map, paths[q]) == cost, "threaded batch against A*");
+        check(pathCost(map, expected[q]) == cost, "single-threaded batch against A*");
+    }
+}
+
+// Seeking the trace to an iteration, in any order, shows what a search
+// stopped at that iteration has
+static void trace() {
+    const char* names[] = { "astar", "greedy", "jps", "alt" };
+    std::mt19937 rng(10);
+    Map map(40, 40);
+
+    for(const char* name : names) {
+        randomMap(map, rng, 150, false);
+        std::unique_ptr<PFAlgorithm> recorded(makeAlgorithm(name, map));
+        std::unique_ptr<PFAlgorithm> stopped(makeAlgorithm(name, map));
+
+        recorded->trace.recording = true;
+        recorded->reset();
+        recorded->toEnd();
+        unsigned int end = recorded->iterations;
+
+        for(unsigned int round = 0; round < 30; ++round) {
+            unsigned int target = rng() % (end + 1);
+
+            // Half of the time arrive by stepping back from one further on
+            if(round % 2 == 1 && target < end) {
+                recorded->iteration = target + 1;
+                recorded->rewind();
+            } else {
+                recorded->iteration = target;
+                recorded->trace.seek(target);
+            }
+
+            stopped->reset();
+            stopped->iteration = target;
+            stopped->run(false);
+
+            const Trace& view = recorded->trace;
+            bool same = view.current() == stopped->current || target == 0;
+
+            for(unsigned int node = 0; node < map.size(); ++node) {
+                same = same && view.isClosed(node) == stopped->search.closed(node) &&
+                       view.isOpen(node) == stopped->openList.contains(node) &&
+                       view.cameFrom(node) == stopped->search.cameFrom(node) &&
+                       view.gCost(node) == stopped->search.gCost(node);
+            }
+
+            std::ostringstream what;
+            what << name << " trace at " << target << " of " << end;
+            check(same, what.str());
+        }
+
+        stopped->run(true);
+        recorded->toEnd();
+        check(recorded->trace.atEnd() && recorded->path() == stopped->path(), std::string(name) + " trace back at the end");
+    }
+}
+
+// Snapshots handed over while the worker runs, and its final one
+static void worker() {
+    std::mt19937 rng(11);
+    Map map(120, 120);
+    randomMap(map, rng, 1500, false);
+
+    std::unique_ptr<PFAlgorithm> algorithm(makeAlgorithm("astar", map));
+    std::unique_ptr<PFAlgorithm> reference(makeAlgorithm("astar", map));
+    SearchWorker worker;
+
+    algorithm->trace.recording = true;
+    algorithm->reset();
+    reference->reset();
+    reference->run(true);
+
+    worker.start(algorithm.get(), Map::infinity, 0);
+    unsigned int last = 0;
+
+    while(!worker.finished()) {
+        if(worker.poll()) {
+            const SearchWorker::Snapshot& snapshot = worker.snapshot();
+            check(snapshot.cells.size() == map.size() && snapshot.iteration >= last, "snapshots move forward");
+            last = snapshot.iteration;
+        }
+    }
+
+    worker.poll();
+    worker.cancel();
+
+    const SearchWorker::Snapshot& snapshot = worker.snapshot();
+    bool same = snapshot.finished && snapshot.iteration == reference->iterations &&
+                algorithm->iteration == reference->iterations && snapshot.cells.size() == map.size();
+
+    for(unsigned int node = 0; same && node < map.size(); ++node) {
+        SearchWorker::State state = reference->search.closed(node) ? SearchWorker::closed :
+                                    (reference->openList.contains(node) ? SearchWorker::open : SearchWorker::unseen);
+        same = snapshot.cells[node] == state;
+    }
+
+    check(same, "final snapshot");
+    check(algorithm->path() == reference->path(), "worker path");
+
+    // Cancelled partway at a slow rate, the search stays where it got to
+    algorithm->reset();
+    algorithm->iteration = 0;
+    worker.start(algorithm.get(), Map::infinity, 100);
+    worker.cancel();
+
+    check(!worker.running() && algorithm->iteration < reference->iterations, "cancelled worker");
+}
+
+int main(int argc, char const** argv) {
+    struct Group {
+        const char* name;
+        void (*run)();
+    };
+
+    const Group groups[] = {
+        { "optimal", optimal },
+        { "incremental", incremental },
+        { "connectivity", connectivity },
+        { "mapfile", mapFile },
+        { "lineofsight", lineOfSightChecks },
+        { "batch", batch },
+        { "trace", trace },
+        { "worker", worker },
+    };
+
+    for(const Group& group : groups) {
+        bool selected = argc < 2;
+
+        for(int a = 1; a < argc; ++a) {
+            selected = selected || std::strcmp(argv[a], group.name) == 0;
+        }
+
+        if(selected) {
+            unsigned int before = failures;
+            group.run();
+            std::cout << group.name << ": " << (failures == before ? "ok" : "failed") << "\n";
+        }
+    }
+
+    return failures == 0 ? 0 : 1;
+}